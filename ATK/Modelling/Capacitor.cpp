@@ -20,6 +20,13 @@ namespace ATK
     inner.update_steady_state(dt, modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]));
   }
   
+  template<typename DataType_>
+  void Capacitor<DataType_>::update_time_step(DataType dt)
+  {
+    Parent::update_time_step(dt);
+    inner.update_time_step(dt, modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]));
+  }
+  
   template<typename DataType_>
   void Capacitor<DataType_>::update_state()
   {
@@ -46,11 +53,59 @@ namespace ATK
     return inner.get_gradient() * (0 == pin_index_ref ? 1 : -1) * (1 == pin_index ? 1 : -1);
   }
 
+  template<typename DataType_>
+  void Capacitor<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    if(steady_state)
+    {
+      Parent::stamp_dipole(eqs, jacobian_values, 0, 0);
+      return;
+    }
+    Parent::stamp_dipole(eqs, jacobian_values, inner.get_current(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1])), inner.get_gradient());
+  }
+
+  template<typename DataType_>
+  bool Capacitor<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
+
   template<typename DataType_>
   DataType_ Capacitor<DataType_>::get_capacitance() const
   {
     return inner.get_capacitance();
   }
 
+  template<typename DataType_>
+  gsl::index Capacitor<DataType_>::get_state_size() const
+  {
+    return 1;
+  }
+
+  template<typename DataType_>
+  void Capacitor<DataType_>::save_state(DataType* state) const
+  {
+    inner.save_state(state);
+  }
+
+  template<typename DataType_>
+  void Capacitor<DataType_>::restore_state(const DataType* state)
+  {
+    inner.restore_state(state);
+  }
+
+  template<typename DataType_>
+  void Capacitor<DataType_>::append_values(std::string& description) const
+  {
+    inner.append_values(description);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Capacitor<DataType_>::clone() const
+  {
+    return std::make_unique<Capacitor<DataType_>>(*this);
+  }
+
+  template class Capacitor<float>;
   template class Capacitor<double>;
 }
@@ -20,6 +20,13 @@ namespace ATK
     inner.update_steady_state(dt);
   }
   
+  template<typename DataType_>
+  void Coil<DataType_>::update_time_step(DataType dt)
+  {
+    Parent::update_time_step(dt);
+    inner.update_time_step(dt, modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]));
+  }
+  
   template<typename DataType_>
   void Coil<DataType_>::update_state()
   {
@@ -37,6 +44,18 @@ namespace ATK
   {
     return inner.get_gradient(steady_state)  * (0 == pin_index_ref ? 1 : -1) * (1 == pin_index ? 1 : -1);
   }
+
+  template<typename DataType_>
+  void Coil<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    Parent::stamp_dipole(eqs, jacobian_values, inner.get_current(), inner.get_gradient(steady_state));
+  }
+
+  template<typename DataType_>
+  bool Coil<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
   
   template<typename DataType_>
   void Coil<DataType_>::precompute(bool steady_state)
@@ -50,5 +69,36 @@ namespace ATK
     return inner.get_coil();
   }
 
+  template<typename DataType_>
+  gsl::index Coil<DataType_>::get_state_size() const
+  {
+    return 2;
+  }
+
+  template<typename DataType_>
+  void Coil<DataType_>::save_state(DataType* state) const
+  {
+    inner.save_state(state);
+  }
+
+  template<typename DataType_>
+  void Coil<DataType_>::restore_state(const DataType* state)
+  {
+    inner.restore_state(state);
+  }
+
+  template<typename DataType_>
+  void Coil<DataType_>::append_values(std::string& description) const
+  {
+    inner.append_values(description);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Coil<DataType_>::clone() const
+  {
+    return std::make_unique<Coil<DataType_>>(*this);
+  }
+
+  template class Coil<float>;
   template class Coil<double>;
 }
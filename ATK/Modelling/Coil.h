@@ -26,6 +26,12 @@ namespace ATK
      * @param dt is the delat that will be used in following updates
      */
     void update_steady_state(DataType dt) override;
+
+    /**
+     * Changes the time step of the component without changing its electrical state
+     * @param dt is the delta that will be used in following updates
+     */
+    void update_time_step(DataType dt) override;
     
     /**
      * Update the component for its current state condition
@@ -47,6 +53,29 @@ namespace ATK
      */
     DataType_ get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
 
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// Returns the number of values saved by save_state()
+    gsl::index get_state_size() const override;
+    /// Saves the equivalent voltage and the current of the last step
+    void save_state(DataType* state) const override;
+    /// Restores the equivalent voltage and the current of the last step
+    void restore_state(const DataType* state) override;
+    /// Appends the inductance to a description
+    void append_values(std::string& description) const override;
+
+    /**
+     * Adds the currents and gradients of this component to the equations and the jacobian
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const override;
+
+    /// The gradient of this component only depends on its value
+    bool has_constant_gradient() const override;
+
     /**
      * Precompute internal value before asking current and gradients
      * @param steady_state is a flag to indcate steady state computation (used for some components)
@@ -3,6 +3,9 @@
  */
 
 #include "Component.h"
+#include "ValueDescription.h"
+
+#include <array>
 
 #include <ATK/Core/Utilities.h>
 
@@ -19,6 +22,20 @@ namespace ATK
     this->pins = std::move(pins);
   }
 
+  template<typename DataType_>
+  void Component<DataType_>::set_slots(std::vector<gsl::index> current_slots, std::vector<gsl::index> gradient_slots)
+  {
+    this->current_slots = std::move(current_slots);
+    this->gradient_slots = std::move(gradient_slots);
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::swap_slots(std::vector<gsl::index>& current_slots, std::vector<gsl::index>& gradient_slots)
+  {
+    this->current_slots.swap(current_slots);
+    this->gradient_slots.swap(gradient_slots);
+  }
+
   template<typename DataType_>
   void Component<DataType_>::update_model(DynamicModellerFilter<DataType>* modeller)
   {
@@ -31,6 +48,12 @@ namespace ATK
     this->dt = dt;
   }
   
+  template<typename DataType_>
+  void Component<DataType_>::update_time_step(DataType dt)
+  {
+    this->dt = dt;
+  }
+  
   template<typename DataType_>
   void Component<DataType_>::update_state()
   {
@@ -41,11 +64,101 @@ namespace ATK
   {
   }
   
+  template<typename DataType_>
+  void Component<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    gsl::index nb_pins = pins.size();
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      if(current_slots[i] == -1)
+      {
+        continue;
+      }
+      eqs(current_slots[i]) += get_current(i, steady_state);
+      if(jacobian_values == nullptr)
+      {
+        continue;
+      }
+      for(gsl::index j = 0; j < nb_pins; ++j)
+      {
+        auto slot = gradient_slots[i * nb_pins + j];
+        if(slot != -1)
+        {
+          jacobian_values[slot] += get_gradient(i, j, steady_state);
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::stamp_dipole(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, DataType current, DataType gradient) const
+  {
+    if(current_slots[0] != -1)
+    {
+      eqs(current_slots[0]) += current;
+    }
+    if(current_slots[1] != -1)
+    {
+      eqs(current_slots[1]) += -current;
+    }
+    if(jacobian_values == nullptr)
+    {
+      return;
+    }
+    const std::array<DataType, 4> gradients{{-gradient, gradient, gradient, -gradient}};
+    for(gsl::index i = 0; i < 4; ++i)
+    {
+      if(gradient_slots[i] != -1)
+      {
+        jacobian_values[gradient_slots[i]] += gradients[i];
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::stamp_transconductance(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, DataType current, DataType gradient) const
+  {
+    if(current_slots[2] != -1)
+    {
+      eqs(current_slots[2]) += -current;
+    }
+    if(current_slots[3] != -1)
+    {
+      eqs(current_slots[3]) += current;
+    }
+    if(jacobian_values == nullptr)
+    {
+      return;
+    }
+    // Only the currents of the output pins depend on the control pins, stored at pin_index_ref * 4 + pin_index
+    const std::array<gsl::index, 4> offsets{{8, 9, 12, 13}};
+    const std::array<DataType, 4> gradients{{-gradient, gradient, gradient, -gradient}};
+    for(gsl::index i = 0; i < 4; ++i)
+    {
+      if(gradient_slots[offsets[i]] != -1)
+      {
+        jacobian_values[gradient_slots[offsets[i]]] += gradients[i];
+      }
+    }
+  }
+
+  template<typename DataType_>
+  bool Component<DataType_>::has_constant_gradient() const
+  {
+    return false;
+  }
+  
   template<typename DataType_>
   void Component<DataType_>::add_equation(gsl::index eq_index, gsl::index eq_number, Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>& jacobian, bool steady_state) const
   {
   }
 
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Component<DataType_>::clone() const
+  {
+    throw RuntimeError("This component can't be cloned");
+  }
+
   template<typename DataType_>
   gsl::index Component<DataType_>::get_number_parameters() const
   {
@@ -70,5 +183,31 @@ namespace ATK
     throw RuntimeError("No such parameter");
   }
 
+  template<typename DataType_>
+  gsl::index Component<DataType_>::get_state_size() const
+  {
+    return 0;
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::save_state(DataType* state) const
+  {
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::restore_state(const DataType* state)
+  {
+  }
+
+  template<typename DataType_>
+  void Component<DataType_>::append_values(std::string& description) const
+  {
+    for(gsl::index i = 0; i < get_number_parameters(); ++i)
+    {
+      append_bytes(description, get_parameter(i));
+    }
+  }
+
+  template class Component<float>;
   template class Component<double>;
 }
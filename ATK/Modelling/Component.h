@@ -5,6 +5,8 @@
 #ifndef ATK_MODELLING_COMPONENT_H
 #define ATK_MODELLING_COMPONENT_H
 
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -37,14 +39,45 @@ namespace ATK
     /// The current modeller where the component is located
     DynamicModellerFilter<DataType>* modeller;
 
+    /// Equation row of the current of each pin, -1 if the pin is not dynamic or if its equation is a custom one
+    std::vector<gsl::index> current_slots;
+    /// Offset in the jacobian values of the gradient of each (pin_index_ref, pin_index) pair, -1 if there is none
+    std::vector<gsl::index> gradient_slots;
+
+    /// Copies the pins, the time step and the state of a component, the modeller is set when the copy is added to a modeller
+    Component(const Component&) = default;
+
+    /**
+     * Stamps a two pins component, the current flows from pin 1 to pin 0 and its gradient is taken against pin 1
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values to update, can be nullptr
+     * @param current is the current leaving through pin 0
+     * @param gradient is the gradient of this current
+     */
+    void stamp_dipole(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, DataType current, DataType gradient) const;
+
+    /**
+     * Stamps a four pins component whose current flows from pin 2 to pin 3 and is controlled by the voltage between pins 0 and 1
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values to update, can be nullptr
+     * @param current is the current flowing from pin 2 to pin 3 through the component
+     * @param gradient is the gradient of this current against the control voltage
+     */
+    void stamp_transconductance(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, DataType current, DataType gradient) const;
+
   public:
     /// Virtual destructor
     virtual ~Component();
 
     Component() = default;
-    Component(const Component&) = delete;
     Component& operator=(const Component&) = delete;
 
+    /**
+     * Returns a copy of this component and of its state, to be added to another modeller
+     * The default implementation throws a RuntimeError, the component can't be cloned
+     */
+    virtual std::unique_ptr<Component> clone() const;
+
     /**
      * sets the pins for the component
      * @params pins is the set of pins for this component
@@ -57,6 +90,26 @@ namespace ATK
       return pins;
     }
     
+    /**
+     * Sets where the currents and gradients of this component are stored by stamp()
+     * @param current_slots are the equation rows of the current of each pin
+     * @param gradient_slots are the offsets in the jacobian values of the gradients, stored by pin_index_ref then pin_index
+     */
+    void set_slots(std::vector<gsl::index> current_slots, std::vector<gsl::index> gradient_slots);
+    
+    /**
+     * Exchanges the slots of this component with other ones, without allocating memory
+     * @param current_slots are the new equation rows of the currents, they get the old ones
+     * @param gradient_slots are the new offsets of the gradients, they get the old ones
+     */
+    void swap_slots(std::vector<gsl::index>& current_slots, std::vector<gsl::index>& gradient_slots);
+    
+    /// Returns the offsets in the jacobian values of the gradients of this component
+    const std::vector<gsl::index>& get_gradient_slots() const
+    {
+      return gradient_slots;
+    }
+    
     /**
      * Used to indicate if the modeller needs to update its set of equations with those provided by this component
      * @param modeller the modeller to update
@@ -68,6 +121,13 @@ namespace ATK
      * @param dt is the delat that will be used in following updates
      */
     virtual void update_steady_state(DataType dt);
+
+    /**
+     * Changes the time step of the component without changing its electrical state, used to split a sample in sub steps
+     * Called after update_state(), when the state of the modeller is the last converged one
+     * @param dt is the delta that will be used in following updates
+     */
+    virtual void update_time_step(DataType dt);
     
     /**
      * Update the component for its current state condition
@@ -94,6 +154,21 @@ namespace ATK
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     virtual DataType get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const = 0;
+
+    /**
+     * Adds all the currents and gradients of this component to the equations and the jacobian
+     * The default implementation calls get_current() and get_gradient() for each pin
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr if only the currents are required
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    virtual void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const;
+    
+    /**
+     * Indicates if the gradients of this component are independent of the state
+     * Such gradients are only computed again after a steady state update or a parameter change
+     */
+    virtual bool has_constant_gradient() const;
     
     /**
      * Add a new equation to the modeller
@@ -115,6 +190,28 @@ namespace ATK
     
     /// Set the value of a parameter
     virtual void set_parameter(gsl::index identifier, DataType_ value);
+
+    /// Returns the number of values saved by save_state()
+    virtual gsl::index get_state_size() const;
+
+    /**
+     * Saves the internal state of the component, what is kept between two samples besides the voltages
+     * @param state is where the get_state_size() values are stored
+     */
+    virtual void save_state(DataType* state) const;
+
+    /**
+     * Restores an internal state saved by save_state(), the time step has to be the same
+     * @param state contains the get_state_size() values
+     */
+    virtual void restore_state(const DataType* state);
+
+    /**
+     * Appends the bytes of the values that define the behavior of the component to a description, used to identify a circuit
+     * The default implementation appends the parameters
+     * @param description is the description to extend
+     */
+    virtual void append_values(std::string& description) const;
   };
 }
 
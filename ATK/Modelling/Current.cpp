@@ -24,6 +24,12 @@ namespace ATK
   {
     return inner.get_gradient();
   }
+
+  template<typename DataType_>
+  bool Current<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
   
   template<typename DataType_>
   DataType_ Current<DataType_>::get_current() const
@@ -31,5 +37,18 @@ namespace ATK
     return inner.get_current();
   }
   
+  template<typename DataType_>
+  void Current<DataType_>::append_values(std::string& description) const
+  {
+    inner.append_values(description);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Current<DataType_>::clone() const
+  {
+    return std::make_unique<Current<DataType_>>(*this);
+  }
+
+  template class Current<float>;
   template class Current<double>;
 }
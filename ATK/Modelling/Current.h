@@ -35,6 +35,15 @@ namespace ATK
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     DataType_ get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// Appends the current to a description
+    void append_values(std::string& description) const override;
+
+    /// The gradient of this component only depends on its value
+    bool has_constant_gradient() const override;
     
     /// Return the current value
     DataType_ get_current() const;
@@ -24,6 +24,12 @@ namespace ATK
   {
     return inner.get_gradient() * (0 == pin_index_ref ? 1 : -1) * (1 == pin_index ? 1 : -1);
   }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    Parent::stamp_dipole(eqs, jacobian_values, inner.get_current(), inner.get_gradient());
+  }
   
   template<typename DataType_, unsigned int direct, unsigned int indirect>
   void Diode<DataType_, direct, indirect>::precompute(bool steady_state)
@@ -31,6 +37,69 @@ namespace ATK
     inner.precompute(modeller->retrieve_voltage(pins[0]) , modeller->retrieve_voltage(pins[1]) );
   }
 
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::get_exponents(DataType* exponents)
+  {
+    exponents[0] = inner.get_exponent(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]));
+  }
+  
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::set_exponentials(const DataType* values)
+  {
+    inner.set_exponential(values[0]);
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::set_junction_limiting(bool limiting)
+  {
+    inner.set_limiting(limiting);
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  bool Diode<DataType_, direct, indirect>::is_limited() const
+  {
+    return inner.is_limited();
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::reset_junction_limiting()
+  {
+    inner.reset_limiting(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]));
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  gsl::index Diode<DataType_, direct, indirect>::get_state_size() const
+  {
+    return 2;
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::save_state(DataType* state) const
+  {
+    inner.save_state(state);
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::restore_state(const DataType* state)
+  {
+    inner.restore_state(state);
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  void Diode<DataType_, direct, indirect>::append_values(std::string& description) const
+  {
+    inner.append_values(description);
+  }
+
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  std::unique_ptr<Component<DataType_>> Diode<DataType_, direct, indirect>::clone() const
+  {
+    return std::make_unique<Diode<DataType_, direct, indirect>>(*this);
+  }
+
+  template class Diode<float, 1, 0>;
+  template class Diode<float, 1, 1>;
+  template class Diode<float, 2, 1>;
   template class Diode<double, 1, 0>;
   template class Diode<double, 1, 1>;
   template class Diode<double, 2, 1>;
@@ -7,15 +7,187 @@
 #include <boost/log/trivial.hpp>
 #endif
 
+#include "Capacitor.h"
+#include "Coil.h"
 #include "Component.h"
+#include "Diode.h"
 #include "DynamicModellerFilter.h"
+#include "ExponentialControlledCurrent.h"
+#include "Resistor.h"
+#include "Transistor.h"
+#include "VoltageControlledCurrent.h"
 
 #include <ATK/Core/Utilities.h>
 
-constexpr gsl::index MAX_ITERATION = 200;
-constexpr double EPS = 1e-8;
+#include <boost/functional/hash.hpp>
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
+
 constexpr gsl::index INIT_WARMUP = 10;
-constexpr double MAX_DELTA = 1e-1;
+constexpr gsl::index PREDICTOR_PROBE_PERIOD = 64;
+constexpr double PREDICTOR_SMOOTHING = 0.125;
+constexpr gsl::index MAX_LINE_SEARCH = 8;
+constexpr double LINE_SEARCH_DECREASE = 1e-4;
+constexpr gsl::index OVERSAMPLING_TAPS_PER_PHASE = 16;
+constexpr gsl::index PARAMETER_QUEUE_SIZE = 256;
+constexpr gsl::index EXPONENTIAL_SMOOTHING_LENGTH = 10;
+constexpr gsl::index MAX_UPDATE_PINS = 4;
+
+namespace
+{
+  /// Identifies a snapshot of a modeller
+  constexpr char SNAPSHOT_MAGIC[8] = {'A', 'T', 'K', 'S', 'N', 'A', 'P', 'S'};
+  /// Version of the snapshot format, to be increased when it changes
+  constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+  /// Writes values one after the other in a snapshot, or only counts their size when there is no buffer
+  class SnapshotWriter
+  {
+  public:
+    explicit SnapshotWriter(char* buffer)
+    :buffer(buffer)
+    {
+    }
+
+    template<typename T>
+    void write(const T* values, gsl::index count)
+    {
+      if(buffer != nullptr)
+      {
+        std::memcpy(buffer + size, values, count * sizeof(T));
+      }
+      size += count * sizeof(T);
+    }
+
+    template<typename T>
+    void write_value(T value)
+    {
+      write(&value, 1);
+    }
+
+    gsl::index get_size() const
+    {
+      return size;
+    }
+
+  private:
+    char* buffer;
+    gsl::index size = 0;
+  };
+
+  /// Reads values one after the other from a snapshot
+  class SnapshotReader
+  {
+  public:
+    SnapshotReader(const char* buffer, gsl::index size)
+    :buffer(buffer), size(size)
+    {
+    }
+
+    template<typename T>
+    void read(T* values, gsl::index count)
+    {
+      if(position + static_cast<gsl::index>(count * sizeof(T)) > size)
+      {
+        throw ATK::RuntimeError("Truncated modeller snapshot");
+      }
+      std::memcpy(values, buffer + position, count * sizeof(T));
+      position += count * sizeof(T);
+    }
+
+    template<typename T>
+    T read_value()
+    {
+      T value;
+      read(&value, 1);
+      return value;
+    }
+
+  private:
+    const char* buffer;
+    gsl::index size;
+    gsl::index position = 0;
+  };
+
+  /// Components with exponentials that can be computed in a batch
+  template<typename T, typename = void>
+  struct is_junction: public std::false_type
+  {
+  };
+  
+  template<typename T>
+  struct is_junction<T, std::void_t<decltype(T::nb_exponentials)>>: public std::true_type
+  {
+  };
+
+  /**
+   * Same as ColPivHouseholderQR::solve(), but with our own buffers instead of a temporary
+   * @param solver is the QR decomposition of the matrix
+   * @param rhs is the right hand side, it is overwritten
+   * @param result is the solution
+   */
+  template<typename Solver, typename Vector>
+  void solve_qr(const Solver& solver, Vector& rhs, Vector& result)
+  {
+    using DataType = typename Vector::Scalar;
+    auto nonzero_pivots = solver.nonzeroPivots();
+    if(nonzero_pivots == 0)
+    {
+      result.setZero();
+      return;
+    }
+    
+    const auto& qr = solver.matrixQR();
+    const auto& h_coeffs = solver.hCoeffs();
+    gsl::index size = rhs.size();
+
+    // Apply the Householder reflectors one by one, as Eigen would use dynamic temporaries here
+    for(gsl::index k = 0; k < nonzero_pivots; ++k)
+    {
+      auto tail_size = size - k - 1;
+      DataType tmp = h_coeffs(k) * (rhs(k) + qr.col(k).tail(tail_size).dot(rhs.tail(tail_size)));
+      rhs(k) -= tmp;
+      rhs.tail(tail_size) -= tmp * qr.col(k).tail(tail_size);
+    }
+    qr.topLeftCorner(nonzero_pivots, nonzero_pivots).template triangularView<Eigen::Upper>().solveInPlace(rhs.head(nonzero_pivots));
+    
+    const auto& permutation = solver.colsPermutation().indices();
+    for(gsl::index i = 0; i < nonzero_pivots; ++i)
+    {
+      result(permutation(i)) = rhs(i);
+    }
+    for(gsl::index i = nonzero_pivots; i < size; ++i)
+    {
+      result(permutation(i)) = 0;
+    }
+  }
+
+  /// Blackman windowed sinc low pass filter, cut at 90% of the Nyquist frequency of the original sampling rate
+  template<typename DataType>
+  Eigen::Matrix<DataType, Eigen::Dynamic, 1> compute_oversampling_filter(gsl::index oversampling)
+  {
+    gsl::index size = oversampling * OVERSAMPLING_TAPS_PER_PHASE;
+    DataType cutoff = 0.45 / oversampling;
+    DataType pi = boost::math::constants::pi<DataType>();
+    Eigen::Matrix<DataType, Eigen::Dynamic, 1> filter(size);
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      DataType x = i - (size - 1) / 2.;
+      DataType sinc = x == 0 ? 1 : std::sin(2 * pi * cutoff * x) / (2 * pi * cutoff * x);
+      DataType window = 0.42 - 0.5 * std::cos(2 * pi * i / (size - 1)) + 0.08 * std::cos(4 * pi * i / (size - 1));
+      filter(i) = sinc * window;
+    }
+    return filter;
+  }
+}
 
 namespace ATK
 {
@@ -31,7 +203,9 @@ namespace ATK
   , static_state(Eigen::Matrix<DataType, Eigen::Dynamic, 1>::Zero(nb_static_pins))
   , input_state(Eigen::Matrix<DataType, Eigen::Dynamic, 1>::Zero(nb_input_pins))
   , initialized(false)
+  , parameter_queue(PARAMETER_QUEUE_SIZE)
   {
+    parameter_ramps.reserve(PARAMETER_QUEUE_SIZE);
   }
   
   template<typename DataType_>
@@ -39,6 +213,118 @@ namespace ATK
   {
   }
   
+  template<typename DataType_>
+  std::unique_ptr<ModellerFilter<DataType_>> DynamicModellerFilter<DataType_>::clone() const
+  {
+    return clone_dynamic();
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<DynamicModellerFilter<DataType_>> DynamicModellerFilter<DataType_>::clone_dynamic() const
+  {
+    auto model = std::make_unique<DynamicModellerFilter>(nb_dynamic_pins, nb_static_pins, nb_input_pins);
+    model->dynamic_pins_names = dynamic_pins_names;
+    model->static_pins_names = static_pins_names;
+
+    // Settings that are used when components are added or during setup
+    model->junction_limiting = junction_limiting;
+    model->solver_type = solver_type;
+    model->mixed_precision = mixed_precision;
+    model->max_substep_depth = max_substep_depth;
+    model->oversampling = oversampling;
+    model->chord_newton = chord_newton;
+    model->chord_contraction_threshold = chord_contraction_threshold;
+    model->chord_max_samples = chord_max_samples;
+    model->newton_strategy = newton_strategy;
+    model->predictor = predictor;
+    model->statistics_enabled = statistics_enabled;
+    model->iterations_budget = iterations_budget;
+    model->time_budget = time_budget;
+    model->degraded_iterations = degraded_iterations;
+    model->steady_state_cache = steady_state_cache;
+
+    // Waiting and smoothed parameter changes are not copied, their handles are bound to these components
+    // Components are copied with their state, custom equations are set again when they are added
+    for(const auto& component: components)
+    {
+      model->add_component(component->clone(), component->get_pins());
+    }
+    model->static_state = static_state;
+    model->dynamic_state = dynamic_state;
+    model->input_state = input_state;
+    model->initialized = initialized;
+
+    if(input_sampling_rate != 0)
+    {
+      model->set_input_sampling_rate(input_sampling_rate);
+      model->set_output_sampling_rate(output_sampling_rate);
+    }
+    if(workspace_allocated)
+    {
+      model->setup();
+      // The extrapolation of the next samples uses the same history
+      model->state_history = state_history;
+      model->history_size = history_size;
+      model->predicted_iterations = predicted_iterations;
+      model->previous_state_iterations = previous_state_iterations;
+      model->predictor_samples = predictor_samples;
+      model->previous_input = previous_input;
+      if(oversampling > 1)
+      {
+        model->input_history = input_history;
+        model->output_history = output_history;
+        model->input_history_position = input_history_position;
+        model->output_history_position = output_history_position;
+      }
+      copy_solver_state(*model);
+    }
+    return model;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::copy_solver_state(DynamicModellerFilter& model) const
+  {
+    model.constant_jacobian = constant_jacobian;
+    model.constant_steady_jacobian = constant_steady_jacobian;
+    model.constant_jacobian_valid = constant_jacobian_valid;
+    model.previous_residual = previous_residual;
+    model.factorization_age = factorization_age;
+    model.factorization_valid = factorization_valid;
+    if(!factorization_valid)
+    {
+      return;
+    }
+
+    model.jacobian = jacobian;
+    model.solver = solver;
+    if(mixed_precision)
+    {
+      model.mixed_jacobian = mixed_jacobian;
+      model.mixed_solver = mixed_solver;
+    }
+    if(solver_type == SolverType::Sparse)
+    {
+      model.sparse_fallback = sparse_fallback;
+      if(!sparse_fallback)
+      {
+        // Eigen::SparseLU can't be copied, the sparse jacobian still holds the factorized values
+        model.sparse_jacobian.coeffs() = sparse_jacobian.coeffs();
+        model.sparse_solver.factorize(model.sparse_jacobian);
+      }
+    }
+
+    // The updates of the factorization refer to the components of the new modeller
+    model.update_rank = update_rank;
+    model.update_v = update_v;
+    model.update_z = update_z;
+    model.update_solver = update_solver;
+    for(gsl::index column = 0; column < update_rank; ++column)
+    {
+      auto it = std::find_if(components.begin(), components.end(), [&](const auto& component){return component.get() == update_components[column];});
+      model.update_components[column] = model.components[it - components.begin()].get();
+    }
+  }
+
   template<typename DataType_>
   const Eigen::Matrix<typename DynamicModellerFilter<DataType_>::DataType, Eigen::Dynamic, 1>& DynamicModellerFilter<DataType_>::get_states(PinType type) const
   {
@@ -77,9 +363,54 @@ namespace ATK
     }
     component->set_pins(std::move(pins));
     component->update_model(this);
-    components.insert(std::move(component));
+    
+    auto insert_typed = [&](auto& partition)
+    {
+      using Type = std::remove_pointer_t<typename std::decay_t<decltype(partition)>::value_type>;
+      auto typed_component = dynamic_cast<Type*>(component.get());
+      if(typed_component != nullptr)
+      {
+        if constexpr(is_junction<Type>::value)
+        {
+          typed_component->set_junction_limiting(junction_limiting);
+        }
+        partition.push_back(typed_component);
+      }
+      return typed_component != nullptr;
+    };
+    if(!std::apply([&](auto&... partitions){return (insert_typed(partitions) || ...);}, typed_components))
+    {
+      other_components.push_back(component.get());
+    }
+    components.push_back(std::move(component));
+    if(workspace_allocated)
+    {
+      // the model was already set up, the jacobian structure has to follow the new topology
+      allocate_workspace();
+    }
   }
   
+  template<typename DataType_>
+  template<typename Function>
+  void DynamicModellerFilter<DataType_>::for_each_component(Function&& function) const
+  {
+    std::apply([&](const auto&... partitions)
+    {
+      auto call = [&](const auto& partition)
+      {
+        for(auto component: partition)
+        {
+          function(component);
+        }
+      };
+      (call(partitions), ...);
+    }, typed_components);
+    for(auto component: other_components)
+    {
+      function(component);
+    }
+  }
+
   template<typename DataType_>
   void DynamicModellerFilter<DataType_>::set_custom_equation(gsl::index eq, std::tuple<Component<DataType>*, gsl::index> custom_equation)
   {
@@ -87,217 +418,1762 @@ namespace ATK
   }
 
   template<typename DataType_>
-  void DynamicModellerFilter<DataType_>::init()
+  bool DynamicModellerFilter<DataType_>::init()
   {
-    for(auto& component : components)
-    {
-      component->update_steady_state(1. / input_sampling_rate);
-    }
+    for_each_component([&](auto component){component->update_steady_state(get_circuit_time_step());});
+    constant_jacobian_valid = false;
     
-    solve(true);
+    bool converged = solve(true, MAX_ITERATION) < MAX_ITERATION;
       
-    for(auto& component : components)
-    {
-      component->update_steady_state(1. / input_sampling_rate);
-    }
+    for_each_component([&](auto component){component->update_steady_state(get_circuit_time_step());});
+    constant_jacobian_valid = false;
 #if ENABLE_LOG
     BOOST_LOG_TRIVIAL(trace) << "init state: " << dynamic_state;
 #endif
     
     initialized = true;
+    return converged;
   }
   
   template<typename DataType_>
-  void DynamicModellerFilter<DataType_>::setup()
+  void DynamicModellerFilter<DataType_>::allocate_workspace()
   {
-    assert(input_sampling_rate == output_sampling_rate);
+    eqs.setZero(nb_dynamic_pins);
+    jacobian.setZero(nb_dynamic_pins, nb_dynamic_pins);
+    delta.setZero(nb_dynamic_pins);
+    solver_rhs.setZero(nb_dynamic_pins);
+    substep_states.setZero(nb_dynamic_pins, max_substep_depth + 1);
+    previous_input = input_state;
+    next_input = input_state;
+    best_state.setZero(nb_dynamic_pins);
+    previous_state.setZero(nb_dynamic_pins);
+    solver = Eigen::ColPivHouseholderQR<Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>(nb_dynamic_pins, nb_dynamic_pins);
+    if(mixed_precision)
+    {
+      mixed_jacobian.setZero(nb_dynamic_pins, nb_dynamic_pins);
+      mixed_solver = Eigen::ColPivHouseholderQR<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>>(nb_dynamic_pins, nb_dynamic_pins);
+      mixed_rhs.setZero(nb_dynamic_pins);
+      mixed_delta.setZero(nb_dynamic_pins);
+    }
+    factorization_valid = false;
+    update_rank = 0;
+    update_v.setZero(nb_dynamic_pins, MAX_UPDATE_RANK);
+    update_z.setZero(nb_dynamic_pins, MAX_UPDATE_RANK);
     
-    if(!initialized)
+    if(solver_type == SolverType::Sparse)
     {
-      auto target_static_state = static_state;
-      
-      for(gsl::index i = 0; i < INIT_WARMUP; ++i)
-      {
-        static_state = target_static_state * ((i+1.) / INIT_WARMUP);
-        init();
-      }
-      static_state = target_static_state;
+      analyze_sparse_pattern();
     }
-  }
 
-  template<typename DataType_>
-  void DynamicModellerFilter<DataType_>::process_impl(gsl::index size) const
-  {
-    for(gsl::index i = 0; i < size; ++i)
+    for(const auto& component: components)
     {
-      for(gsl::index j = 0; j < nb_input_ports; ++j)
+      const auto& pins = component->get_pins();
+      std::vector<gsl::index> current_slots(pins.size(), -1);
+      std::vector<gsl::index> gradient_slots(pins.size() * pins.size(), -1);
+      for(gsl::index i = 0; i < pins.size(); ++i)
       {
-        input_state[j] = converted_inputs[j][i];
+        // Currents are only added on Kirchhoff equations
+        if(std::get<0>(pins[i]) != PinType::Dynamic || std::get<0>(dynamic_pins_equation[std::get<1>(pins[i])]) != nullptr)
+        {
+          continue;
+        }
+        current_slots[i] = std::get<1>(pins[i]);
+        for(gsl::index j = 0; j < pins.size(); ++j)
+        {
+          if(std::get<0>(pins[j]) == PinType::Dynamic)
+          {
+            gradient_slots[i * pins.size() + j] = get_jacobian_slot(std::get<1>(pins[i]), std::get<1>(pins[j]));
+          }
+        }
       }
+      component->set_slots(std::move(current_slots), std::move(gradient_slots));
+    }
 
-      solve(false);
-#if ENABLE_LOG
-      BOOST_LOG_TRIVIAL(trace) << "final state: " << dynamic_state;
-#endif
-      
-      for (auto& component : components)
+    custom_equations_slots.clear();
+    for(gsl::index i = 0; i < nb_dynamic_pins; ++i)
+    {
+      if(std::get<0>(dynamic_pins_equation[i]) != nullptr && solver_type == SolverType::Sparse)
       {
-        component->update_state();
+        // Custom equations are computed in the dense jacobian and then copied in the sparse one
+        for(const auto& pin: std::get<0>(dynamic_pins_equation[i])->get_pins())
+        {
+          if(std::get<0>(pin) == PinType::Dynamic)
+          {
+            custom_equations_slots.push_back(std::make_tuple(std::get<1>(pin) * nb_dynamic_pins + i, get_jacobian_slot(i, std::get<1>(pin))));
+          }
+        }
       }
-
-      for(gsl::index j = 0; j < nb_output_ports; ++j)
+    }
+    
+    auto nb_values = solver_type == SolverType::Sparse ? sparse_jacobian.nonZeros() : nb_dynamic_pins * nb_dynamic_pins;
+    constant_steady_jacobian.setZero(nb_values);
+    constant_jacobian.setZero(nb_values);
+    constant_jacobian_valid = false;
+    gsl::index nb_exponentials = 0;
+    gsl::index nb_junction_states = 0;
+    for_each_component([&](auto component)
+    {
+      using Type = std::remove_pointer_t<decltype(component)>;
+      if constexpr(is_junction<Type>::value)
       {
-        outputs[j][i] = dynamic_state[j];
+        nb_exponentials += Type::nb_exponentials;
+        nb_junction_states += component->get_state_size();
       }
-    }
+    });
+    exponents.setZero(nb_exponentials);
+    junction_states.setZero(nb_junction_states);
+    snapshot_component_states.resize(get_component_states_size());
+    state_history.setZero(nb_dynamic_pins, 3);
+    history_size = 0;
+    linear = std::all_of(components.begin(), components.end(), [](const auto& component){return component->has_constant_gradient();});
+    
+    workspace_allocated = true;
   }
 
   template<typename DataType_>
-  void DynamicModellerFilter<DataType_>::solve(bool steady_state) const
+  void DynamicModellerFilter<DataType_>::compute_constant_jacobian() const
   {
-    gsl::index iteration = 0;
-    
-    while(iteration < MAX_ITERATION && !iterate(steady_state))
+    constant_steady_jacobian.setZero();
+    constant_jacobian.setZero();
+    for_each_component([&](auto component)
     {
-      ++iteration;
-    }
-#if ENABLE_LOG
-    BOOST_LOG_TRIVIAL(trace) << "total iterations: " << iteration;
-#endif
+      if(!component->has_constant_gradient())
+      {
+        return;
+      }
+      const auto& gradient_slots = component->get_gradient_slots();
+      gsl::index nb_pins = component->get_pins().size();
+      for(gsl::index i = 0; i < nb_pins; ++i)
+      {
+        for(gsl::index j = 0; j < nb_pins; ++j)
+        {
+          auto slot = gradient_slots[i * nb_pins + j];
+          if(slot != -1)
+          {
+            constant_steady_jacobian(slot) += component->get_gradient(i, j, true);
+            constant_jacobian(slot) += component->get_gradient(i, j, false);
+          }
+        }
+      }
+    });
+    constant_jacobian_valid = true;
   }
 
   template<typename DataType_>
-  bool DynamicModellerFilter<DataType_>::iterate(bool steady_state) const
+  void DynamicModellerFilter<DataType_>::analyze_sparse_pattern()
   {
-    for(auto& component : components)
+    std::vector<Eigen::Triplet<DataType>> pattern;
+    auto add_pins = [&](gsl::index i, const Component<DataType>* component)
     {
-      component->precompute(steady_state);
-    }
-    
-    Eigen::Matrix<DataType, Eigen::Dynamic, 1> eqs(Eigen::Matrix<DataType, Eigen::Dynamic, 1>::Zero(nb_dynamic_pins));
-    Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> jacobian(Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>::Zero(nb_dynamic_pins, nb_dynamic_pins));
+      for(const auto& pin: component->get_pins())
+      {
+        if(std::get<0>(pin) == PinType::Dynamic)
+        {
+          pattern.emplace_back(i, std::get<1>(pin), 0);
+        }
+      }
+    };
     
-    // Populate the equations + jacobian for computing next update
     for(gsl::index i = 0; i < nb_dynamic_pins; ++i)
     {
       if(std::get<0>(dynamic_pins_equation[i]) == nullptr)
       {
-        compute_current(i, eqs, jacobian, steady_state);
+        for(const auto& component: dynamic_pins[i])
+        {
+          add_pins(i, std::get<0>(component));
+        }
       }
       else
       {
-        std::get<0>(dynamic_pins_equation[i])->add_equation(i, std::get<1>(dynamic_pins_equation[i]), eqs, jacobian, steady_state);
+        add_pins(i, std::get<0>(dynamic_pins_equation[i]));
       }
     }
+    
+    sparse_jacobian.resize(nb_dynamic_pins, nb_dynamic_pins);
+    sparse_jacobian.setFromTriplets(pattern.begin(), pattern.end());
+    sparse_jacobian.makeCompressed();
+    sparse_solver.analyzePattern(sparse_jacobian);
+  }
 
-#if ENABLE_LOG
-    BOOST_LOG_TRIVIAL(trace) << "eqs: " << eqs;
-    BOOST_LOG_TRIVIAL(trace) << "jacobian: " << jacobian;
-#endif
-    // Check if the equations have converged
-    if((eqs.array().abs() < EPS).all())
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_jacobian_slot(gsl::index row, gsl::index col)
+  {
+    if(solver_type == SolverType::Sparse)
     {
-      return true;
+      return &sparse_jacobian.coeffRef(row, col) - sparse_jacobian.valuePtr();
     }
+    return col * nb_dynamic_pins + row;
+  }
 
-    Eigen::Matrix<DataType, Eigen::Dynamic, 1> delta = jacobian.colPivHouseholderQr().solve(eqs);
-
-    // Check if the update is big enough
-    if((delta.array().abs() < EPS).all())
-    {
-      return true;
-    }
-    
-    auto max_delta = delta.array().abs().maxCoeff();
-    if(max_delta > MAX_DELTA)
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_solver_type(SolverType solver_type)
+  {
+    this->solver_type = solver_type;
+    if(workspace_allocated)
     {
-      delta *= MAX_DELTA / max_delta;
+      allocate_workspace();
     }
-    
-    dynamic_state -= delta;
-#if ENABLE_LOG
-    BOOST_LOG_TRIVIAL(trace) << "delta: " << delta;
-    BOOST_LOG_TRIVIAL(trace) << "intermediate state: " << dynamic_state;
-#endif
-    
-    return false;
   }
 
   template<typename DataType_>
-  void DynamicModellerFilter<DataType_>::compute_current(gsl::index i, Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>& jacobian, bool steady_state) const
+  SolverType DynamicModellerFilter<DataType_>::get_solver_type() const
   {
-    DataType& current = eqs(i);
-    for(const auto& component: dynamic_pins[i])
-    {
-      current += std::get<0>(component)->get_current(std::get<1>(component), steady_state);
+    return solver_type;
+  }
 
-      const auto& pins = std::get<0>(component)->get_pins();
-      
-      for(gsl::index j = 0; j < pins.size(); ++j)
-      {
-        if(std::get<0>(pins[j]) == PinType::Dynamic)
-        {
-          jacobian(i, std::get<1>(pins[j])) += std::get<0>(component)->get_gradient(std::get<1>(component), j, steady_state);
-        }
-      }
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_mixed_precision(bool mixed_precision)
+  {
+    this->mixed_precision = mixed_precision;
+    factorization_valid = false;
+    if(workspace_allocated)
+    {
+      allocate_workspace();
     }
   }
 
   template<typename DataType_>
-  gsl::index DynamicModellerFilter<DataType_>::get_number_parameters() const
+  bool DynamicModellerFilter<DataType_>::get_mixed_precision() const
   {
-    return std::accumulate(begin(components), end(components), 0, [](gsl::index i, const auto& component)
-                           {
-                             return i + component->get_number_parameters();
-                           }
-           );
+    return mixed_precision;
   }
-  
-  template<typename Components, typename Function>
-  auto scan_components(const Components& components, gsl::index identifier, Function fun)
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_chord_newton(bool chord_newton, DataType contraction_threshold, gsl::index max_samples)
   {
-    gsl::index ind = 0;
-    
-    for(const auto& component: components)
+    if(contraction_threshold <= 0 || contraction_threshold >= 1)
     {
-      if(component->get_number_parameters() == 0)
-      {
-        continue;
-      }
-      if(ind + component->get_number_parameters() >= identifier)
-      {
-        ind += component->get_number_parameters();
-        continue;
-      }
-      return fun(component, identifier - ind);
+      throw RuntimeError("Contraction threshold must be strictly between 0 and 1");
     }
-    throw RuntimeError("No such parameter");
+    if(max_samples <= 0)
+    {
+      throw RuntimeError("Maximum number of samples between two factorizations must be strictly positive");
+    }
+    this->chord_newton = chord_newton;
+    chord_contraction_threshold = contraction_threshold;
+    chord_max_samples = max_samples;
+    factorization_valid = false;
   }
-  
+
   template<typename DataType_>
-  std::string DynamicModellerFilter<DataType_>::get_parameter_name(gsl::index identifier) const
+  bool DynamicModellerFilter<DataType_>::get_chord_newton() const
   {
-    return scan_components(components, identifier, [&](const auto& component, gsl::index i){
-      return component->get_parameter_name(i);
-    });
+    return chord_newton;
   }
-  
+
   template<typename DataType_>
-  DataType_ DynamicModellerFilter<DataType_>::get_parameter(gsl::index identifier) const
+  void DynamicModellerFilter<DataType_>::set_newton_strategy(NewtonStrategy newton_strategy)
   {
-    return scan_components(components, identifier, [&](const auto& component, gsl::index i){
-      return component->get_parameter(i);
-    });
+    this->newton_strategy = newton_strategy;
+  }
+
+  template<typename DataType_>
+  NewtonStrategy DynamicModellerFilter<DataType_>::get_newton_strategy() const
+  {
+    return newton_strategy;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_predictor(PredictorType predictor)
+  {
+    this->predictor = predictor;
+    history_size = 0;
+  }
+
+  template<typename DataType_>
+  PredictorType DynamicModellerFilter<DataType_>::get_predictor() const
+  {
+    return predictor;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_junction_limiting(bool junction_limiting)
+  {
+    this->junction_limiting = junction_limiting;
+    for_each_component([&](auto component)
+    {
+      if constexpr(is_junction<std::remove_pointer_t<decltype(component)>>::value)
+      {
+        component->set_junction_limiting(junction_limiting);
+      }
+    });
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::get_junction_limiting() const
+  {
+    return junction_limiting;
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::is_linear() const
+  {
+    return linear;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::enable_statistics(bool statistics_enabled)
+  {
+    this->statistics_enabled = statistics_enabled;
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::get_statistics_enabled() const
+  {
+    return statistics_enabled;
+  }
+
+  template<typename DataType_>
+  SolverStatistics<DataType_> DynamicModellerFilter<DataType_>::get_statistics() const
+  {
+    return shared_statistics.load();
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_realtime_budget(double iterations_per_sample, double nanoseconds_per_sample, gsl::index degraded_iterations)
+  {
+    if(iterations_per_sample < 0 || nanoseconds_per_sample < 0)
+    {
+      throw RuntimeError("Real time budgets must be positive or null");
+    }
+    if(degraded_iterations < 1 || degraded_iterations > MAX_ITERATION)
+    {
+      throw RuntimeError("The number of degraded iterations must be between 1 and " + std::to_string(MAX_ITERATION));
+    }
+    if(iterations_per_sample > 0 && iterations_per_sample < degraded_iterations + 1)
+    {
+      throw RuntimeError("The iterations budget must allow the degraded iterations and the final evaluation for all samples");
+    }
+    iterations_budget = iterations_per_sample;
+    time_budget = nanoseconds_per_sample;
+    this->degraded_iterations = degraded_iterations;
+  }
+
+  template<typename DataType_>
+  double DynamicModellerFilter<DataType_>::get_iterations_budget() const
+  {
+    return iterations_budget;
+  }
+
+  template<typename DataType_>
+  double DynamicModellerFilter<DataType_>::get_time_budget() const
+  {
+    return time_budget;
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_degraded_iterations() const
+  {
+    return degraded_iterations;
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_nb_degraded_samples() const
+  {
+    return nb_degraded_samples.load(std::memory_order_relaxed);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_max_substeps(gsl::index max_substeps)
+  {
+    if(max_substeps < 1 || (max_substeps & (max_substeps - 1)) != 0)
+    {
+      throw RuntimeError("The maximum number of sub steps must be a power of 2");
+    }
+    max_substep_depth = 0;
+    while((gsl::index(1) << max_substep_depth) < max_substeps)
+    {
+      ++max_substep_depth;
+    }
+    if(workspace_allocated)
+    {
+      allocate_workspace();
+    }
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_max_substeps() const
+  {
+    return gsl::index(1) << max_substep_depth;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_oversampling(gsl::index oversampling)
+  {
+    if(oversampling < 1)
+    {
+      throw RuntimeError("The oversampling factor must be strictly positive");
+    }
+    if(oversampling == this->oversampling)
+    {
+      return;
+    }
+    this->oversampling = oversampling;
+    // The components have to be updated for the new time step
+    initialized = false;
+    if(workspace_allocated)
+    {
+      setup();
+    }
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_oversampling() const
+  {
+    return oversampling;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_steady_state_cache(std::shared_ptr<SteadyStateCache<DataType>> cache)
+  {
+    steady_state_cache = std::move(cache);
+  }
+
+  template<typename DataType_>
+  std::shared_ptr<SteadyStateCache<DataType_>> DynamicModellerFilter<DataType_>::get_steady_state_cache() const
+  {
+    return steady_state_cache;
+  }
+
+  template<typename DataType_>
+  std::size_t DynamicModellerFilter<DataType_>::get_steady_state_key() const
+  {
+    return boost::hash_value(get_steady_state_description());
+  }
+
+  template<typename DataType_>
+  std::string DynamicModellerFilter<DataType_>::get_steady_state_description() const
+  {
+    std::string description;
+    auto append = [&](const auto& value)
+    {
+      description.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    append(nb_dynamic_pins);
+    append(nb_static_pins);
+    append(nb_input_pins);
+    for(const auto& component: components)
+    {
+      // The mangled name of the type is stable for a given build, contrary to type_info::hash_code()
+      description += typeid(*component).name();
+      description += '\0';
+      for(const auto& pin: component->get_pins())
+      {
+        append(static_cast<int>(std::get<0>(pin)));
+        append(std::get<1>(pin));
+      }
+      // The values are appended as they are, so that two circuits only share a description if their components have the same values
+      component->append_values(description);
+    }
+    description.append(reinterpret_cast<const char*>(static_state.data()), static_state.size() * sizeof(DataType));
+    description.append(reinterpret_cast<const char*>(input_state.data()), input_state.size() * sizeof(DataType));
+    append(input_sampling_rate);
+    append(oversampling);
+    // The limitation changes the iterations, and so the steady state they reach
+    append(junction_limiting);
+    return description;
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_component_states_size() const
+  {
+    gsl::index size = 0;
+    for(const auto& component: components)
+    {
+      size += component->get_state_size();
+    }
+    return size;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::save_component_states(DataType* states) const
+  {
+    for(const auto& component: components)
+    {
+      component->save_state(states);
+      states += component->get_state_size();
+    }
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::restore_component_states(const DataType* states)
+  {
+    for(const auto& component: components)
+    {
+      component->restore_state(states);
+      states += component->get_state_size();
+    }
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::load_steady_state()
+  {
+    if(!steady_state_cache)
+    {
+      return false;
+    }
+    // The description of the circuit is checked, another circuit with the same key is a miss
+    auto description = get_steady_state_description();
+    typename SteadyStateCache<DataType>::Entry entry;
+    if(!steady_state_cache->find(boost::hash_value(description), entry) || entry.description != description
+      || entry.dynamic_state.size() != nb_dynamic_pins || static_cast<gsl::index>(entry.component_states.size()) != get_component_states_size())
+    {
+      return false;
+    }
+
+    dynamic_state = entry.dynamic_state;
+    // The components get the coefficients of the new time step before their converged state
+    for_each_component([&](auto component){component->update_steady_state(get_circuit_time_step());});
+    restore_component_states(entry.component_states.data());
+    constant_jacobian_valid = false;
+    initialized = true;
+    return true;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::store_steady_state() const
+  {
+    if(!steady_state_cache)
+    {
+      return;
+    }
+    typename SteadyStateCache<DataType>::Entry entry;
+    entry.description = get_steady_state_description();
+    entry.dynamic_state = dynamic_state;
+    entry.component_states.resize(get_component_states_size());
+    save_component_states(entry.component_states.data());
+    auto key = boost::hash_value(entry.description);
+    steady_state_cache->insert(key, std::move(entry));
+  }
+
+  template<typename DataType_>
+  std::size_t DynamicModellerFilter<DataType_>::get_circuit_key() const
+  {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, nb_dynamic_pins);
+    boost::hash_combine(seed, nb_static_pins);
+    boost::hash_combine(seed, nb_input_pins);
+    for(const auto& component: components)
+    {
+      // Hashed without a temporary string so that restoring a snapshot doesn't allocate
+      const char* name = typeid(*component).name();
+      boost::hash_range(seed, name, name + std::strlen(name));
+      for(const auto& pin: component->get_pins())
+      {
+        boost::hash_combine(seed, static_cast<int>(std::get<0>(pin)));
+        boost::hash_combine(seed, std::get<1>(pin));
+      }
+    }
+    return seed;
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::write_snapshot(char* buffer) const
+  {
+    SnapshotWriter writer(buffer);
+    writer.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.write_value<std::uint32_t>(SNAPSHOT_VERSION);
+    writer.write_value<std::uint32_t>(sizeof(DataType));
+    writer.write_value<std::uint64_t>(get_circuit_key());
+    writer.write_value<std::uint64_t>(snapshot_component_states.size());
+    writer.write_value<std::uint64_t>(get_number_parameters());
+    writer.write_value<std::uint64_t>(input_sampling_rate);
+    writer.write_value<std::uint64_t>(oversampling);
+
+    writer.write(dynamic_state.data(), dynamic_state.size());
+    writer.write(static_state.data(), static_state.size());
+    writer.write(input_state.data(), input_state.size());
+    writer.write(previous_input.data(), previous_input.size());
+    writer.write(state_history.data(), state_history.size());
+    writer.write_value<std::int64_t>(history_size);
+    writer.write_value(predicted_iterations);
+    writer.write_value(previous_state_iterations);
+    writer.write_value<std::int64_t>(predictor_samples);
+    for(const auto& component: components)
+    {
+      for(gsl::index i = 0; i < component->get_number_parameters(); ++i)
+      {
+        writer.write_value(component->get_parameter(i));
+      }
+    }
+    if(buffer != nullptr)
+    {
+      save_component_states(snapshot_component_states.data());
+    }
+    writer.write(snapshot_component_states.data(), snapshot_component_states.size());
+    if(oversampling > 1)
+    {
+      writer.write(input_history.data(), input_history.size());
+      writer.write(output_history.data(), output_history.size());
+      writer.write_value<std::int64_t>(input_history_position);
+      writer.write_value<std::int64_t>(output_history_position);
+    }
+    return writer.get_size();
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_snapshot_size() const
+  {
+    if(!workspace_allocated)
+    {
+      throw RuntimeError("The modeller must be set up before its state can be saved");
+    }
+    return write_snapshot(nullptr);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::save_snapshot(char* buffer, gsl::index size) const
+  {
+    if(size < get_snapshot_size())
+    {
+      throw RuntimeError("The buffer is too small for the modeller snapshot");
+    }
+    write_snapshot(buffer);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::restore_snapshot(const char* buffer, gsl::index size)
+  {
+    if(!workspace_allocated)
+    {
+      throw RuntimeError("The modeller must be set up before a snapshot can be restored");
+    }
+    SnapshotReader reader(buffer, size);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    reader.read(magic, sizeof(magic));
+    if(!std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC))
+    {
+      throw RuntimeError("Not a modeller snapshot");
+    }
+    if(reader.read_value<std::uint32_t>() != SNAPSHOT_VERSION)
+    {
+      throw RuntimeError("Unsupported modeller snapshot version");
+    }
+    if(reader.read_value<std::uint32_t>() != sizeof(DataType))
+    {
+      throw RuntimeError("Modeller snapshot saved with another precision");
+    }
+    if(reader.read_value<std::uint64_t>() != get_circuit_key()
+      || reader.read_value<std::uint64_t>() != snapshot_component_states.size()
+      || reader.read_value<std::uint64_t>() != static_cast<std::uint64_t>(get_number_parameters()))
+    {
+      throw RuntimeError("Modeller snapshot of another circuit");
+    }
+    if(reader.read_value<std::uint64_t>() != static_cast<std::uint64_t>(input_sampling_rate)
+      || reader.read_value<std::uint64_t>() != static_cast<std::uint64_t>(oversampling))
+    {
+      throw RuntimeError("Modeller snapshot saved with another sampling rate");
+    }
+    // The whole snapshot is checked before the state is changed
+    if(size < get_snapshot_size())
+    {
+      throw RuntimeError("Truncated modeller snapshot");
+    }
+
+    reader.read(dynamic_state.data(), dynamic_state.size());
+    reader.read(static_state.data(), static_state.size());
+    reader.read(input_state.data(), input_state.size());
+    reader.read(previous_input.data(), previous_input.size());
+    reader.read(state_history.data(), state_history.size());
+    history_size = static_cast<gsl::index>(reader.read_value<std::int64_t>());
+    predicted_iterations = reader.read_value<DataType>();
+    previous_state_iterations = reader.read_value<DataType>();
+    predictor_samples = static_cast<gsl::index>(reader.read_value<std::int64_t>());
+    for(const auto& component: components)
+    {
+      for(gsl::index i = 0; i < component->get_number_parameters(); ++i)
+      {
+        auto value = reader.read_value<DataType>();
+        if(value != component->get_parameter(i))
+        {
+          component->set_parameter(i, value);
+        }
+      }
+    }
+    // The internal states are restored after the parameters, as some components update them with their parameters
+    reader.read(snapshot_component_states.data(), snapshot_component_states.size());
+    restore_component_states(snapshot_component_states.data());
+    if(oversampling > 1)
+    {
+      reader.read(input_history.data(), input_history.size());
+      reader.read(output_history.data(), output_history.size());
+      input_history_position = static_cast<gsl::index>(reader.read_value<std::int64_t>());
+      output_history_position = static_cast<gsl::index>(reader.read_value<std::int64_t>());
+    }
+
+    ParameterChange<DataType> change;
+    while(parameter_queue.pop(change))
+    {
+    }
+    parameter_ramps.clear();
+    constant_jacobian_valid = false;
+    factorization_valid = false;
+    update_rank = 0;
+    initialized = true;
+  }
+
+  template<typename DataType_>
+  typename DynamicModellerFilter<DataType_>::DataType DynamicModellerFilter<DataType_>::get_circuit_time_step() const
+  {
+    return static_cast<DataType>(1) / (input_sampling_rate * oversampling);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::setup_oversampling()
+  {
+    if(oversampling == 1)
+    {
+      this->set_latency(0);
+      return;
+    }
+    // Both filters delay by (size - 1) / 2 oversampled samples, and the decimation uses the last phase, oversampling - 1 samples after the input
+    this->set_latency(OVERSAMPLING_TAPS_PER_PHASE - 1);
+    auto filter = compute_oversampling_filter<DataType>(oversampling);
+    // Each phase is normalized so that constant inputs are kept
+    upsampling_filters.resize(OVERSAMPLING_TAPS_PER_PHASE, oversampling);
+    for(gsl::index phase = 0; phase < oversampling; ++phase)
+    {
+      for(gsl::index i = 0; i < OVERSAMPLING_TAPS_PER_PHASE; ++i)
+      {
+        upsampling_filters(i, phase) = filter(i * oversampling + phase);
+      }
+      upsampling_filters.col(phase) /= upsampling_filters.col(phase).sum();
+    }
+    decimation_filter = filter / filter.sum();
+
+    input_history.resize(2 * OVERSAMPLING_TAPS_PER_PHASE, nb_input_ports);
+    for(gsl::index j = 0; j < nb_input_ports; ++j)
+    {
+      input_history.col(j).setConstant(input_state[j]);
+    }
+    output_history.resize(2 * filter.size(), nb_output_ports);
+    for(gsl::index j = 0; j < nb_output_ports; ++j)
+    {
+      output_history.col(j).setConstant(dynamic_state[j]);
+    }
+    input_history_position = 0;
+    output_history_position = 0;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_time_step(DataType dt) const
+  {
+    if(dt == time_step)
+    {
+      return;
+    }
+    for_each_component([&](auto component){component->update_time_step(dt);});
+    time_step = dt;
+    constant_jacobian_valid = false;
+    factorization_valid = false;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::setup()
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+    
+    allocate_workspace();
+
+    if(!initialized && !load_steady_state())
+    {
+      auto target_static_state = static_state;
+      bool converged = false;
+      
+      for(gsl::index i = 0; i < INIT_WARMUP; ++i)
+      {
+        static_state = target_static_state * ((i+1.) / INIT_WARMUP);
+        converged = init();
+      }
+      static_state = target_static_state;
+      // A steady state that didn't converge is not shared, the next modellers try again
+      if(converged)
+      {
+        store_steady_state();
+      }
+    }
+    time_step = get_circuit_time_step();
+    setup_oversampling();
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    bool budgeted = !linear && (iterations_budget > 0 || time_budget > 0);
+    std::chrono::steady_clock::time_point start;
+    if(statistics_enabled || budgeted)
+    {
+      start = std::chrono::steady_clock::now();
+    }
+    if(statistics_enabled)
+    {
+      block_statistics = SolverStatistics<DataType>();
+    }
+    gsl::index block_iterations = 0;
+    gsl::index block_degraded = 0;
+    gsl::index nb_samples = size * oversampling;
+
+    // Solves the circuit for the current input state
+    auto process_sample = [&](gsl::index sample)
+    {
+      bool predicted = start_sample();
+      auto max_iterations = budgeted ? get_max_iterations(nb_samples - sample, block_iterations, nb_samples, start) : MAX_ITERATION;
+      auto iterations = solve(false, max_iterations);
+      bool converged = iterations < max_iterations;
+      // The budget takes precedence over the sub steps
+      if(!converged && !linear && max_substep_depth > 0 && max_iterations == MAX_ITERATION)
+      {
+        dynamic_state = substep_states.col(0);
+        converged = solve_substeps(0, 1, 1, iterations);
+        if(statistics_enabled)
+        {
+          ++block_statistics.nb_substepped;
+        }
+      }
+      bool degraded = !converged && max_iterations < MAX_ITERATION;
+      // The evaluations done after the iterations cost as much as an iteration
+      block_iterations += iterations + final_evaluations;
+      block_degraded += degraded ? 1 : 0;
+      if(statistics_enabled)
+      {
+        block_statistics.add_sample(iterations, converged, degraded, final_residual);
+      }
+      finish_sample(predicted, iterations);
+    };
+
+    if(oversampling == 1)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        for(gsl::index j = 0; j < nb_input_ports; ++j)
+        {
+          input_state[j] = converted_inputs[j][i];
+        }
+
+        process_sample(i);
+
+        for(gsl::index j = 0; j < nb_output_ports; ++j)
+        {
+          outputs[j][i] = dynamic_state[j];
+        }
+      }
+    }
+    else
+    {
+      gsl::index decimation_size = decimation_filter.size();
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        input_history_position = (input_history_position + OVERSAMPLING_TAPS_PER_PHASE - 1) % OVERSAMPLING_TAPS_PER_PHASE;
+        for(gsl::index j = 0; j < nb_input_ports; ++j)
+        {
+          input_history(input_history_position, j) = converted_inputs[j][i];
+          input_history(input_history_position + OVERSAMPLING_TAPS_PER_PHASE, j) = converted_inputs[j][i];
+        }
+
+        for(gsl::index phase = 0; phase < oversampling; ++phase)
+        {
+          for(gsl::index j = 0; j < nb_input_ports; ++j)
+          {
+            input_state[j] = upsampling_filters.col(phase).dot(input_history.col(j).segment(input_history_position, OVERSAMPLING_TAPS_PER_PHASE));
+          }
+
+          process_sample(i * oversampling + phase);
+
+          output_history_position = (output_history_position + decimation_size - 1) % decimation_size;
+          for(gsl::index j = 0; j < nb_output_ports; ++j)
+          {
+            output_history(output_history_position, j) = dynamic_state[j];
+            output_history(output_history_position + decimation_size, j) = dynamic_state[j];
+          }
+        }
+
+        for(gsl::index j = 0; j < nb_output_ports; ++j)
+        {
+          outputs[j][i] = decimation_filter.dot(output_history.col(j).segment(output_history_position, decimation_size));
+        }
+      }
+    }
+
+    if(block_degraded > 0)
+    {
+      nb_degraded_samples.fetch_add(block_degraded, std::memory_order_relaxed);
+    }
+    if(statistics_enabled)
+    {
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      block_statistics.nanoseconds_per_sample = size > 0 ? elapsed.count() / size : 0;
+      shared_statistics.store(block_statistics);
+    }
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::start_sample() const
+  {
+    update_parameters();
+    if(!linear && max_substep_depth > 0)
+    {
+      substep_states.col(0) = dynamic_state;
+      next_input = input_state;
+    }
+    return !linear && predict();
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::finish_sample(bool predicted, gsl::index iterations) const
+  {
+    update_history(predicted, iterations);
+    ++factorization_age;
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "final state: " << dynamic_state;
+#endif
+    
+    for_each_component([](auto component){component->update_state();});
+    if(!linear && max_substep_depth > 0)
+    {
+      set_time_step(get_circuit_time_step());
+      previous_input = next_input;
+    }
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::solve(bool steady_state, gsl::index max_iterations) const
+  {
+    final_evaluations = 0;
+    if(linear && !steady_state)
+    {
+      solve_linear();
+      // The linear path doesn't compute the equations, its solution is exact
+      final_residual = 0;
+      return 1;
+    }
+    if(junction_limiting)
+    {
+      reset_junction_limiting();
+    }
+    gsl::index iteration = 0;
+    previous_residual = std::numeric_limits<DataType>::max();
+    // When the iterations are bounded, the state with the smallest residual is kept
+    bool bounded = max_iterations < MAX_ITERATION;
+    DataType best_residual = std::numeric_limits<DataType>::max();
+    
+    while(iteration < max_iterations)
+    {
+      if(bounded)
+      {
+        previous_state = dynamic_state;
+      }
+      if(iterate(steady_state))
+      {
+        // The converged iteration evaluated the equations without counting as an iteration
+        final_evaluations = 1;
+        break;
+      }
+      ++iteration;
+      if(bounded)
+      {
+        if(iteration_residual < best_residual)
+        {
+          best_residual = iteration_residual;
+          best_state.swap(previous_state);
+        }
+      }
+    }
+    
+    // The residual of the returned state is only needed by the statistics and the budget, it costs an evaluation on the samples that didn't converge
+    if(statistics_enabled || bounded)
+    {
+      if(iteration == max_iterations)
+      {
+        // The last iteration updated the state after computing the equations, they are evaluated again for the returned state
+        precompute(steady_state);
+        compute_equations(steady_state, false);
+        final_evaluations = 1;
+      }
+      // A converged iteration returns without changing the state, its equations were computed for the returned state
+      final_residual = eqs.size() > 0 ? eqs.array().abs().maxCoeff() : 0;
+      if(bounded && iteration == max_iterations && best_residual < final_residual)
+      {
+        // The components are precomputed again with the kept state, coils update their state from their precomputed current
+        dynamic_state = best_state;
+        final_residual = best_residual;
+        precompute(steady_state);
+        ++final_evaluations;
+      }
+    }
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "total iterations: " << iteration;
+#endif
+    return iteration;
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::solve_substeps(DataType start, DataType end, gsl::index depth, gsl::index& iterations) const
+  {
+    bool converged = true;
+    DataType middle = (start + end) / 2;
+    for(auto [substep_start, substep_end]: {std::make_tuple(start, middle), std::make_tuple(middle, end)})
+    {
+      if(substep_start != start)
+      {
+        // The first half is committed before solving the second one
+        for_each_component([](auto component){component->update_state();});
+      }
+      substep_states.col(depth) = dynamic_state;
+      set_time_step((substep_end - substep_start) * get_circuit_time_step());
+      input_state = previous_input + substep_end * (next_input - previous_input);
+
+      auto substep_iterations = solve(false, MAX_ITERATION);
+      iterations += substep_iterations;
+      if(substep_iterations < MAX_ITERATION)
+      {
+        continue;
+      }
+      if(depth < max_substep_depth)
+      {
+        dynamic_state = substep_states.col(depth);
+        converged = solve_substeps(substep_start, substep_end, depth + 1, iterations) && converged;
+      }
+      else
+      {
+        converged = false;
+      }
+    }
+    return converged;
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_max_iterations(gsl::index remaining_samples, gsl::index block_iterations, gsl::index block_size, std::chrono::steady_clock::time_point start) const
+  {
+    double available = std::numeric_limits<double>::max();
+    if(iterations_budget > 0)
+    {
+      available = iterations_budget * block_size - block_iterations;
+    }
+    if(time_budget > 0 && block_iterations > 0)
+    {
+      // The time left is converted in iterations with the mean cost of an iteration in this block
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      double iteration_cost = elapsed.count() / block_iterations;
+      available = std::min(available, (time_budget * block_size - elapsed.count()) / iteration_cost);
+    }
+    // Keep enough iterations for the degraded mode of the next samples, each sample ends with an evaluation of its state
+    available -= static_cast<double>(remaining_samples - 1) * (degraded_iterations + 1) + 1;
+    return static_cast<gsl::index>(std::max<double>(degraded_iterations, std::min<double>(available, MAX_ITERATION)));
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::predict() const
+  {
+    gsl::index order = std::min<gsl::index>(static_cast<gsl::index>(predictor), history_size - 1);
+    if(order <= 0)
+    {
+      return false;
+    }
+    
+    // Use the extrapolation only while it converges at least as fast as the previous state, and regularly check the other choice
+    bool use_prediction = predicted_iterations <= previous_state_iterations;
+    if(++predictor_samples % PREDICTOR_PROBE_PERIOD == 0)
+    {
+      use_prediction = !use_prediction;
+    }
+    if(!use_prediction)
+    {
+      return false;
+    }
+    
+    if(order == 1)
+    {
+      dynamic_state = 2 * state_history.col(0) - state_history.col(1);
+    }
+    else
+    {
+      dynamic_state = 3 * state_history.col(0) - 3 * state_history.col(1) + state_history.col(2);
+    }
+    return true;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::update_history(bool predicted, gsl::index iterations) const
+  {
+    if(predictor == PredictorType::ZeroOrder)
+    {
+      return;
+    }
+    auto& average_iterations = predicted ? predicted_iterations : previous_state_iterations;
+    average_iterations += (iterations - average_iterations) * PREDICTOR_SMOOTHING;
+    
+    for(gsl::index i = state_history.cols() - 1; i > 0; --i)
+    {
+      state_history.col(i) = state_history.col(i - 1);
+    }
+    state_history.col(0) = dynamic_state;
+    history_size = std::min<gsl::index>(history_size + 1, state_history.cols());
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::precompute(bool steady_state) const
+  {
+    gather_exponents(steady_state, exponents.data());
+    // Eigen uses the SIMD exponential of the current architecture, with a scalar fallback
+    exponents = exponents.exp();
+    return scatter_exponentials(exponents.data());
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::gather_exponents(bool steady_state, DataType* values) const
+  {
+    gsl::index offset = 0;
+    for_each_component([&](auto component)
+    {
+      using Type = std::remove_pointer_t<decltype(component)>;
+      if constexpr(is_junction<Type>::value)
+      {
+        component->get_exponents(values + offset);
+        offset += Type::nb_exponentials;
+      }
+      else
+      {
+        component->precompute(steady_state);
+      }
+    });
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::save_junction_states() const
+  {
+    DataType* states = junction_states.data();
+    for_each_component([&](auto component)
+    {
+      if constexpr(is_junction<std::remove_pointer_t<decltype(component)>>::value)
+      {
+        component->save_state(states);
+        states += component->get_state_size();
+      }
+    });
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::restore_junction_states() const
+  {
+    const DataType* states = junction_states.data();
+    for_each_component([&](auto component)
+    {
+      if constexpr(is_junction<std::remove_pointer_t<decltype(component)>>::value)
+      {
+        component->restore_state(states);
+        states += component->get_state_size();
+      }
+    });
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::reset_junction_limiting() const
+  {
+    for_each_component([](auto component)
+    {
+      if constexpr(is_junction<std::remove_pointer_t<decltype(component)>>::value)
+      {
+        component->reset_junction_limiting();
+      }
+    });
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::scatter_exponentials(const DataType* values) const
+  {
+    gsl::index offset = 0;
+    bool limited = false;
+    for_each_component([&](auto component)
+    {
+      using Type = std::remove_pointer_t<decltype(component)>;
+      if constexpr(is_junction<Type>::value)
+      {
+        component->set_exponentials(values + offset);
+        offset += Type::nb_exponentials;
+        limited |= component->is_limited();
+      }
+    });
+    return limited;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::solve_linear() const
+  {
+    precompute(false);
+    
+    // The jacobian is constant, it is only factorized again after a steady state computation or a parameter change
+    compute_equations(false, !factorization_valid);
+    if(!factorization_valid)
+    {
+      factorize(false);
+    }
+    solve_delta();
+    dynamic_state -= delta;
+    // Coils update their state from the current they precomputed, it has to be the current of the solution
+    precompute(false);
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "delta: " << delta;
+#endif
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::iterate(bool steady_state) const
+  {
+    return iterate_precomputed(steady_state, precompute(steady_state));
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::iterate_precomputed(bool steady_state, bool limited) const
+  {
+    // With the chord method, the jacobian is only assembled when the old factorization is not good enough anymore
+    bool reuse_factorization = chord_newton && !steady_state && factorization_valid && factorization_age < chord_max_samples;
+    compute_equations(steady_state, !reuse_factorization);
+
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "eqs: " << eqs;
+    BOOST_LOG_TRIVIAL(trace) << "jacobian: " << jacobian;
+#endif
+    if(limited && statistics_enabled)
+    {
+      ++block_statistics.nb_limited_iterations;
+    }
+    // Check if the equations have converged, the equations of limited junctions are only approximations
+    // The criterion doesn't depend on the limitation, so that it only changes the iterations and not the solution
+    if(!limited && (eqs.array().abs() < EPS).all())
+    {
+      return true;
+    }
+
+    // Residual of the state before the update, the line search evaluates the equations at other states
+    iteration_residual = eqs.array().abs().maxCoeff();
+    if(chord_newton)
+    {
+      if(reuse_factorization && iteration_residual > chord_contraction_threshold * previous_residual)
+      {
+        // The old jacobian doesn't reduce the residual fast enough, do a full Newton step
+        reuse_factorization = false;
+        compute_equations(steady_state, true);
+      }
+      previous_residual = iteration_residual;
+    }
+    
+    DataType residual = newton_strategy == NewtonStrategy::LineSearch ? eqs.norm() : 0;
+    if(!reuse_factorization)
+    {
+      factorize(steady_state);
+    }
+    solve_delta();
+
+    // Check if the update is big enough
+    if(!limited && (delta.array().abs() < EPS).all())
+    {
+      return true;
+    }
+    
+    if(newton_strategy == NewtonStrategy::LineSearch)
+    {
+      line_search(steady_state, residual);
+    }
+    else
+    {
+      clamped_update();
+    }
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "delta: " << delta;
+    BOOST_LOG_TRIVIAL(trace) << "intermediate state: " << dynamic_state;
+#endif
+    
+    return false;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::clamped_update() const
+  {
+    auto max_delta = delta.array().abs().maxCoeff();
+    if(max_delta > MAX_DELTA)
+    {
+      delta *= MAX_DELTA / max_delta;
+    }
+    
+    dynamic_state -= delta;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::line_search(bool steady_state, DataType residual) const
+  {
+    // The trial points are not iterations, the limitation of the junction voltages continues from the current iteration
+    if(junction_limiting)
+    {
+      save_junction_states();
+    }
+    DataType step = 1;
+    for(gsl::index i = 0; i < MAX_LINE_SEARCH; ++i)
+    {
+      dynamic_state -= step * delta;
+      precompute(steady_state);
+      compute_equations(steady_state, false);
+      if(junction_limiting)
+      {
+        restore_junction_states();
+      }
+      // Written so that NaN residuals are rejected as well
+      if(eqs.norm() <= (1 - LINE_SEARCH_DECREASE * step) * residual)
+      {
+        return;
+      }
+      dynamic_state += step * delta;
+      step /= 2;
+    }
+    
+    // No sufficient decrease along the Newton direction, use the clamped update instead
+    clamped_update();
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::compute_equations(bool steady_state, bool with_jacobian) const
+  {
+    eqs.setZero();
+    DataType* jacobian_values = nullptr;
+    if(with_jacobian)
+    {
+      if(!constant_jacobian_valid)
+      {
+        compute_constant_jacobian();
+      }
+      const auto& constant_values = steady_state ? constant_steady_jacobian : constant_jacobian;
+      if(solver_type == SolverType::Sparse)
+      {
+        sparse_jacobian.coeffs() = constant_values;
+        jacobian_values = sparse_jacobian.valuePtr();
+      }
+      else
+      {
+        jacobian = Eigen::Map<const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>(constant_values.data(), nb_dynamic_pins, nb_dynamic_pins);
+        jacobian_values = jacobian.data();
+      }
+    }
+    
+    // Populate the equations + jacobian for computing next update
+    stamp_components(eqs, jacobian_values, steady_state);
+    for(gsl::index i = 0; i < nb_dynamic_pins; ++i)
+    {
+      if(std::get<0>(dynamic_pins_equation[i]) != nullptr)
+      {
+        std::get<0>(dynamic_pins_equation[i])->add_equation(i, std::get<1>(dynamic_pins_equation[i]), eqs, jacobian, steady_state);
+      }
+    }
+    if(with_jacobian)
+    {
+      for(const auto& slot: custom_equations_slots)
+      {
+        jacobian_values[std::get<1>(slot)] = jacobian.data()[std::get<0>(slot)];
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::stamp_components(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    for_each_component([&](auto component)
+    {
+      // The constant gradients are already in the jacobian
+      component->stamp(eqs, component->has_constant_gradient() ? nullptr : jacobian_values, steady_state);
+    });
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::factorize(bool steady_state) const
+  {
+    if(statistics_enabled)
+    {
+      ++block_statistics.nb_factorizations;
+    }
+    if(solver_type == SolverType::Sparse)
+    {
+      sparse_solver.factorize(sparse_jacobian);
+      sparse_fallback = sparse_solver.info() != Eigen::Success;
+      if(sparse_fallback)
+      {
+        // Singular system (floating pins during steady state for instance), use the rank revealing QR instead
+        jacobian = sparse_jacobian;
+        factorize_dense();
+      }
+    }
+    else
+    {
+      factorize_dense();
+    }
+    // The steady state jacobian is different from the one used during processing
+    factorization_valid = !steady_state;
+    factorization_age = 0;
+    update_rank = 0;
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::solve_delta() const
+  {
+    solve_factorized_delta();
+    if(update_rank == 0)
+    {
+      return;
+    }
+    // Woodbury formula: (J + U V^T)^-1 = J^-1 - Z (I + V^T Z)^-1 V^T J^-1 with Z = J^-1 U
+    update_rhs.resize(update_rank);
+    for(gsl::index i = 0; i < update_rank; ++i)
+    {
+      update_rhs(i) = update_v.col(i).dot(delta);
+    }
+    update_solution = update_solver.solve(update_rhs);
+    for(gsl::index i = 0; i < update_rank; ++i)
+    {
+      delta -= update_solution(i) * update_z.col(i);
+    }
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::solve_factorized_delta() const
+  {
+    if(solver_type == SolverType::Sparse && !sparse_fallback)
+    {
+      delta = sparse_solver.solve(eqs);
+      if(delta.allFinite())
+      {
+        return;
+      }
+      jacobian = sparse_jacobian;
+      factorize_dense();
+      sparse_fallback = true;
+    }
+    solve_dense_delta();
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::factorize_dense() const
+  {
+    if(mixed_precision)
+    {
+      mixed_jacobian = jacobian.template cast<double>();
+      mixed_solver.compute(mixed_jacobian);
+    }
+    else
+    {
+      solver.compute(jacobian);
+    }
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::solve_dense_delta() const
+  {
+    if(mixed_precision)
+    {
+      mixed_rhs = eqs.template cast<double>();
+      solve_qr(mixed_solver, mixed_rhs, mixed_delta);
+      delta = mixed_delta.template cast<DataType>();
+    }
+    else
+    {
+      solver_rhs = eqs;
+      solve_qr(solver, solver_rhs, delta);
+    }
+  }
+
+  template<typename DataType_>
+  gsl::index DynamicModellerFilter<DataType_>::get_number_parameters() const
+  {
+    return std::accumulate(begin(components), end(components), 0, [](gsl::index i, const auto& component)
+                           {
+                             return i + component->get_number_parameters();
+                           }
+           );
+  }
+  
+  template<typename Components, typename Function>
+  auto scan_components(const Components& components, gsl::index identifier, Function fun)
+  {
+    gsl::index ind = 0;
+    
+    for(const auto& component: components)
+    {
+      if(component->get_number_parameters() == 0)
+      {
+        continue;
+      }
+      if(identifier >= ind + component->get_number_parameters())
+      {
+        ind += component->get_number_parameters();
+        continue;
+      }
+      return fun(component, identifier - ind);
+    }
+    throw RuntimeError("No such parameter");
+  }
+  
+  template<typename DataType_>
+  std::string DynamicModellerFilter<DataType_>::get_parameter_name(gsl::index identifier) const
+  {
+    return scan_components(components, identifier, [&](const auto& component, gsl::index i){
+      return component->get_parameter_name(i);
+    });
+  }
+  
+  template<typename DataType_>
+  DataType_ DynamicModellerFilter<DataType_>::get_parameter(gsl::index identifier) const
+  {
+    return scan_components(components, identifier, [&](const auto& component, gsl::index i){
+      return component->get_parameter(i);
+    });
   }
   
   template<typename DataType_>
   void DynamicModellerFilter<DataType_>::set_parameter(gsl::index identifier, DataType_ value)
+  {
+    change_parameter(get_parameter_handle(identifier), value);
+  }
+
+  template<typename DataType_>
+  ParameterHandle<DataType_> DynamicModellerFilter<DataType_>::get_parameter_handle(gsl::index identifier) const
   {
     return scan_components(components, identifier, [&](const auto& component, gsl::index i){
-      component->set_parameter(i, value);
+      return ParameterHandle<DataType>{component.get(), i};
     });
-    throw RuntimeError("No such parameter");
   }
 
+  template<typename DataType_>
+  ParameterHandle<DataType_> DynamicModellerFilter<DataType_>::get_parameter_handle(const std::string& name) const
+  {
+    for(const auto& component: components)
+    {
+      for(gsl::index i = 0; i < component->get_number_parameters(); ++i)
+      {
+        if(component->get_parameter_name(i) == name)
+        {
+          return ParameterHandle<DataType>{component.get(), i};
+        }
+      }
+    }
+    throw RuntimeError("No such parameter: " + name);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::set_parameter(const ParameterHandle<DataType>& handle, DataType value)
+  {
+    change_parameter(handle, value);
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::change_parameter(const ParameterHandle<DataType>& handle, DataType value) const
+  {
+    auto component = handle.component;
+    gsl::index nb_pins = component->get_pins().size();
+    // Updates are only useful if the factorization is reused for the next samples
+    if(!(linear || chord_newton) || !factorization_valid || !constant_jacobian_valid || !component->has_constant_gradient() || nb_pins > MAX_UPDATE_PINS)
+    {
+      component->set_parameter(handle.index, value);
+      // The jacobian depends on the parameters
+      factorization_valid = false;
+      constant_jacobian_valid = false;
+      return;
+    }
+
+    using GradientMatrix = Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic, 0, MAX_UPDATE_PINS, MAX_UPDATE_PINS>;
+    const auto& gradient_slots = component->get_gradient_slots();
+    GradientMatrix gradients_delta = GradientMatrix::Zero(nb_pins, nb_pins);
+    GradientMatrix steady_gradients_delta = GradientMatrix::Zero(nb_pins, nb_pins);
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      for(gsl::index j = 0; j < nb_pins; ++j)
+      {
+        if(gradient_slots[i * nb_pins + j] != -1)
+        {
+          gradients_delta(i, j) = -component->get_gradient(i, j, false);
+          steady_gradients_delta(i, j) = -component->get_gradient(i, j, true);
+        }
+      }
+    }
+    component->set_parameter(handle.index, value);
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      for(gsl::index j = 0; j < nb_pins; ++j)
+      {
+        auto slot = gradient_slots[i * nb_pins + j];
+        if(slot != -1)
+        {
+          gradients_delta(i, j) += component->get_gradient(i, j, false);
+          steady_gradients_delta(i, j) += component->get_gradient(i, j, true);
+          constant_jacobian(slot) += gradients_delta(i, j);
+          constant_steady_jacobian(slot) += steady_gradients_delta(i, j);
+        }
+      }
+    }
+
+    if(!add_low_rank_update(component, gradients_delta))
+    {
+      factorization_valid = false;
+    }
+  }
+
+  template<typename DataType_>
+  template<typename Matrix>
+  bool DynamicModellerFilter<DataType_>::add_low_rank_update(const Component<DataType>* component, Matrix gradients_delta) const
+  {
+    const auto& pins = component->get_pins();
+    auto scale = gradients_delta.cwiseAbs().maxCoeff();
+    // Rank one parts are removed row after row, so that successive changes of a component give the same V columns
+    // A resistor changes its gradients by g (1 -1)^T (1 -1), a potentiometer by two such parts
+    for(gsl::index pivot_row = 0; pivot_row < gradients_delta.rows(); ++pivot_row)
+    {
+      Eigen::Index pivot_col = 0;
+      auto pivot_value = gradients_delta.row(pivot_row).cwiseAbs().maxCoeff(&pivot_col);
+      if(pivot_value <= EPS * scale)
+      {
+        continue;
+      }
+      auto pivot = gradients_delta(pivot_row, pivot_col);
+
+      // The rows are the Kirchhoff equations of the pins, the columns their voltages, only dynamic pins have a non null change
+      eqs.setZero();
+      delta.setZero();
+      for(gsl::index i = 0; i < gradients_delta.rows(); ++i)
+      {
+        if(gradients_delta(i, pivot_col) != 0)
+        {
+          eqs(std::get<1>(pins[i])) += gradients_delta(i, pivot_col);
+        }
+        if(gradients_delta(pivot_row, i) != 0)
+        {
+          delta(std::get<1>(pins[i])) += gradients_delta(pivot_row, i) / pivot;
+        }
+      }
+      for(gsl::index i = 0; i < gradients_delta.rows(); ++i)
+      {
+        if(i == pivot_row)
+        {
+          continue;
+        }
+        auto factor = gradients_delta(i, pivot_col) / pivot;
+        for(gsl::index j = 0; j < gradients_delta.cols(); ++j)
+        {
+          gradients_delta(i, j) -= factor * gradients_delta(pivot_row, j);
+        }
+      }
+      gradients_delta.row(pivot_row).setZero();
+
+      if(!add_rank_one_update(component))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::add_rank_one_update(const Component<DataType>* component) const
+  {
+    // Successive changes of a component have the same V column, only U changes
+    gsl::index column = 0;
+    while(column < update_rank && !(update_components[column] == component && (update_v.col(column) - delta).cwiseAbs().maxCoeff() <= EPS))
+    {
+      ++column;
+    }
+    if(column == MAX_UPDATE_RANK)
+    {
+      return false;
+    }
+    bool new_column = column == update_rank;
+    if(new_column)
+    {
+      update_v.col(column) = delta;
+      update_components[column] = component;
+      ++update_rank;
+    }
+    solve_factorized_delta();
+    if(new_column)
+    {
+      update_z.col(column) = delta;
+    }
+    else
+    {
+      update_z.col(column) += delta;
+    }
+
+    UpdateMatrix capacitance(update_rank, update_rank);
+    for(gsl::index i = 0; i < update_rank; ++i)
+    {
+      for(gsl::index j = 0; j < update_rank; ++j)
+      {
+        capacitance(i, j) = (i == j ? 1 : 0) + update_v.col(i).dot(update_z.col(j));
+      }
+    }
+    update_solver.compute(capacitance);
+    return std::abs(update_solver.determinant()) > EPS;
+  }
+
+  template<typename DataType_>
+  bool DynamicModellerFilter<DataType_>::push_parameter(const ParameterHandle<DataType>& handle, DataType value, ParameterSmoothing smoothing, gsl::index samples)
+  {
+    if(samples < 0)
+    {
+      throw RuntimeError("The smoothing length must be positive or null");
+    }
+    return parameter_queue.push(ParameterChange<DataType>{handle, value, smoothing, samples});
+  }
+
+  template<typename DataType_>
+  void DynamicModellerFilter<DataType_>::update_parameters() const
+  {
+    ParameterChange<DataType> change;
+    while(parameter_queue.pop(change))
+    {
+      // A new change of a smoothed parameter starts from its current value
+      auto ramp = std::find_if(parameter_ramps.begin(), parameter_ramps.end(), [&](const auto& ramp){return ramp.handle == change.handle;});
+      if(ramp != parameter_ramps.end())
+      {
+        parameter_ramps.erase(ramp);
+      }
+      // Smoothing lengths are given at the sampling rate of the inputs
+      auto samples = change.samples * oversampling;
+      if(change.smoothing == ParameterSmoothing::None || samples == 0 || parameter_ramps.size() == parameter_ramps.capacity())
+      {
+        change_parameter(change.handle, change.value);
+      }
+      else
+      {
+        auto value = change.handle.component->get_parameter(change.handle.index);
+        if(change.smoothing == ParameterSmoothing::Linear)
+        {
+          parameter_ramps.push_back(ParameterRamp{change.handle, value, change.value, (change.value - value) / samples, change.smoothing, samples});
+        }
+        else
+        {
+          parameter_ramps.push_back(ParameterRamp{change.handle, value, change.value, static_cast<DataType>(std::exp(-1. / samples)), change.smoothing, EXPONENTIAL_SMOOTHING_LENGTH * samples});
+        }
+      }
+    }
+
+    if(parameter_ramps.empty())
+    {
+      return;
+    }
+    for(auto& ramp: parameter_ramps)
+    {
+      --ramp.remaining_samples;
+      if(ramp.remaining_samples == 0)
+      {
+        ramp.value = ramp.target;
+      }
+      else if(ramp.smoothing == ParameterSmoothing::Linear)
+      {
+        ramp.value += ramp.step;
+      }
+      else
+      {
+        ramp.value = ramp.target + (ramp.value - ramp.target) * ramp.step;
+      }
+      change_parameter(ramp.handle, ramp.value);
+    }
+    parameter_ramps.erase(std::remove_if(parameter_ramps.begin(), parameter_ramps.end(), [](const auto& ramp){return ramp.remaining_samples == 0;}), parameter_ramps.end());
+  }
+
+  template class DynamicModellerFilter<float>;
   template class DynamicModellerFilter<double>;
 }
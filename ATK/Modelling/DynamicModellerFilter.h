@@ -5,8 +5,11 @@
 #ifndef ATK_MODELLING_DYNAMICMODELLERFILTER_H
 #define ATK_MODELLING_DYNAMICMODELLERFILTER_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <tuple>
-#include <unordered_set>
 #include <vector>
 
 #include <gsl/gsl>
@@ -15,11 +18,34 @@
 
 #include "config.h"
 #include "ModellerFilter.h"
+#include "ParameterQueue.h"
+#include "SolverStatistics.h"
+#include "SteadyStateCache.h"
 
 namespace ATK
 {
   template<typename DataType_>
   class Component;
+  template<typename DataType_>
+  class Capacitor;
+  template<typename DataType_>
+  class Coil;
+  template<typename DataType_, unsigned int direct, unsigned int indirect>
+  class Diode;
+  template<typename DataType_>
+  class ExponentialControlledCurrent;
+  template<typename DataType_>
+  class Resistor;
+  template<typename DataType_, template<typename> class StaticModel>
+  class Transistor;
+  template<typename DataType_>
+  class StaticNPN;
+  template<typename DataType_>
+  class StaticPNP;
+  template<typename DataType_>
+  class VoltageControlledCurrent;
+  template<typename DataType_>
+  class LockstepModellerFilter;
   
   /// The main DynamicModellerFilter
   template<typename DataType_>
@@ -36,7 +62,17 @@ namespace ATK
     using Parent::nb_output_ports;
     using Parent::outputs;
 
+    /// Maximum number of Newton iterations for a sample
+    static constexpr gsl::index MAX_ITERATION = 200;
+    /// Convergence threshold of the equations and of the Newton updates
+    static constexpr double EPS = 1e-8;
+    /// Biggest Newton update of a voltage
+    static constexpr double MAX_DELTA = 1e-1;
+
   private:
+    /// The lockstep filter drives the Newton iterations of its instances
+    friend class LockstepModellerFilter<DataType_>;
+
     gsl::index nb_dynamic_pins;
     gsl::index nb_static_pins;
     gsl::index nb_input_pins;
@@ -50,15 +86,165 @@ namespace ATK
     Eigen::Matrix<DataType, Eigen::Dynamic, 1> static_state;
     mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> input_state;
 
-    std::unordered_set<std::unique_ptr<Component<DataType>>> components;
+    /// All components, in insertion order
+    std::vector<std::unique_ptr<Component<DataType>>> components;
+    /// Components of the usual final types, grouped by type so that their calls are statically dispatched
+    std::tuple<std::vector<Resistor<DataType>*>, std::vector<Capacitor<DataType>*>, std::vector<Coil<DataType>*>,
+      std::vector<Diode<DataType, 1, 0>*>, std::vector<Diode<DataType, 1, 1>*>, std::vector<Diode<DataType, 2, 1>*>,
+      std::vector<Transistor<DataType, StaticNPN>*>, std::vector<Transistor<DataType, StaticPNP>*>,
+      std::vector<VoltageControlledCurrent<DataType>*>, std::vector<ExponentialControlledCurrent<DataType>*>> typed_components;
+    /// The other components, called through the virtual interface
+    std::vector<Component<DataType>*> other_components;
+    
+    /**
+     * Calls a function on all components, typed components first, then the other ones
+     * @param function is a generic callable that will receive a pointer to each component
+     */
+    template<typename Function>
+    void for_each_component(Function&& function) const;
     
     bool initialized = false;
+    /// Steady states shared with other modellers, can be nullptr
+    std::shared_ptr<SteadyStateCache<DataType>> steady_state_cache;
+    /// Internal states of the components, gathered when a snapshot is written or restored
+    mutable std::vector<DataType> snapshot_component_states;
     
     const Eigen::Matrix<DataType, Eigen::Dynamic, 1>& get_states(PinType type) const;
 
     std::vector<std::string> dynamic_pins_names;
     std::vector<std::string> static_pins_names;
 
+    /// Newton solver workspace, sized in setup() so that process_impl() doesn't allocate with the dense solver
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> eqs;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> jacobian;
+    mutable Eigen::ColPivHouseholderQR<Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>> solver;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> delta;
+    /// Intermediate vector used when applying the QR decomposition
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> solver_rhs;
+    bool workspace_allocated = false;
+    /// Dense linear solve in double precision, used when the modeller works in single precision
+    bool mixed_precision = false;
+    mutable Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> mixed_jacobian;
+    mutable Eigen::ColPivHouseholderQR<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>> mixed_solver;
+    mutable Eigen::Matrix<double, Eigen::Dynamic, 1> mixed_rhs;
+    mutable Eigen::Matrix<double, Eigen::Dynamic, 1> mixed_delta;
+
+    SolverType solver_type = SolverType::Dense;
+    /// Sparse jacobian, its pattern is computed once in setup()
+    mutable Eigen::SparseMatrix<DataType> sparse_jacobian;
+    mutable Eigen::SparseLU<Eigen::SparseMatrix<DataType>, Eigen::COLAMDOrdering<int>> sparse_solver;
+    /// Jacobian values of the components with a constant gradient, for steady state and for processing
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> constant_steady_jacobian;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> constant_jacobian;
+    mutable bool constant_jacobian_valid = false;
+    NewtonStrategy newton_strategy = NewtonStrategy::Clamped;
+    PredictorType predictor = PredictorType::ZeroOrder;
+    /// Last converged states, most recent first
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> state_history;
+    mutable gsl::index history_size = 0;
+    /// Running averages of the number of iterations when starting from the extrapolation or from the previous state
+    mutable DataType predicted_iterations = 0;
+    mutable DataType previous_state_iterations = 0;
+    mutable gsl::index predictor_samples = 0;
+
+    /// Limitation of the junction voltages of diodes and transistors during the Newton iterations
+    bool junction_limiting = false;
+    /// Arguments of the exponentials of the junctions, computed in a single batch
+    mutable Eigen::Array<DataType, Eigen::Dynamic, 1> exponents;
+    /// Internal states of the junctions, kept during the evaluation of the line search trial points
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> junction_states;
+    /// Set when all components have constant gradients, one linear solve per sample is then enough
+    bool linear = false;
+    /// Offsets in the dense jacobian and in the sparse jacobian values of the custom equations gradients
+    std::vector<std::tuple<gsl::index, gsl::index>> custom_equations_slots;
+    /// Set when the sparse factorization failed and the dense QR decomposition is used instead
+    mutable bool sparse_fallback = false;
+
+    /// Chord method settings, the last factorization is reused while the residual decreases fast enough
+    bool chord_newton = false;
+    DataType chord_contraction_threshold = 0.5;
+    gsl::index chord_max_samples = 32;
+    /// State of the last factorization
+    mutable bool factorization_valid = false;
+    mutable gsl::index factorization_age = 0;
+    mutable DataType previous_residual = 0;
+
+    /// Maximum rank of the updates of the factorization before it is computed again
+    static constexpr gsl::index MAX_UPDATE_RANK = 8;
+    using UpdateMatrix = Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic, 0, MAX_UPDATE_RANK, MAX_UPDATE_RANK>;
+    using UpdateVector = Eigen::Matrix<DataType, Eigen::Dynamic, 1, 0, MAX_UPDATE_RANK, 1>;
+    /// Parameter changes since the last factorization, the jacobian being the factorized one plus U V^T
+    mutable gsl::index update_rank = 0;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> update_v;
+    /// Solutions of the factorized jacobian for the columns of U
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> update_z;
+    /// Component of each column, successive changes of a component are merged
+    mutable std::array<const Component<DataType>*, MAX_UPDATE_RANK> update_components;
+    /// Decomposition of I + V^T Z for the Woodbury formula, with a fixed maximum size so that it doesn't allocate
+    mutable Eigen::PartialPivLU<UpdateMatrix> update_solver;
+    mutable UpdateVector update_rhs;
+    mutable UpdateVector update_solution;
+
+    /// Solver statistics, accumulated during a block and published at its end
+    bool statistics_enabled = false;
+    mutable SolverStatistics<DataType> block_statistics;
+    mutable SharedSolverStatistics<DataType> shared_statistics;
+    /// Biggest absolute equation residual of the state found by the last solve, only computed for the statistics and the budget
+    mutable DataType final_residual = 0;
+    /// Number of evaluations of the equations done by the last solve on top of its iterations
+    mutable gsl::index final_evaluations = 0;
+
+    /// Real time budget of each block, expressed per sample, 0 disables a budget
+    double iterations_budget = 0;
+    double time_budget = 0;
+    /// Number of iterations allowed per sample once the budget of the block is exhausted
+    gsl::index degraded_iterations = 4;
+    /// Best state found during iterations that may not converge
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> best_state;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> previous_state;
+    /// Biggest absolute equation residual of the state before the update of the last iteration
+    mutable DataType iteration_residual = 0;
+    /// Number of samples that couldn't converge because of the budget, since the creation of the filter
+    mutable std::atomic<gsl::index> nb_degraded_samples{0};
+
+    /// Maximum number of times a non converging sample is split in two sub steps, 0 disables sub steps
+    gsl::index max_substep_depth = 0;
+    /// Time step currently used by the components
+    mutable DataType time_step = 0;
+    /// State at the beginning of each level of sub steps
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> substep_states;
+    /// Inputs of the previous and of the current samples, interpolated for the sub steps
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> previous_input;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> next_input;
+
+    /// Oversampling factor of the circuit, the up and down sampling filters are fused with the solve
+    gsl::index oversampling = 1;
+    /// Polyphase upsampling filter, one column per phase
+    Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> upsampling_filters;
+    /// Decimation filter, applied on the last oversampled outputs
+    Eigen::Matrix<DataType, Eigen::Dynamic, 1> decimation_filter;
+    /// Last inputs and last oversampled outputs, each value is stored twice so that the most recent ones are always contiguous
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> input_history;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> output_history;
+    mutable gsl::index input_history_position = 0;
+    mutable gsl::index output_history_position = 0;
+
+    /// A parameter going smoothly to a new value
+    struct ParameterRamp
+    {
+      ParameterHandle<DataType> handle;
+      DataType value;
+      DataType target;
+      /// Increment for linear ramps, remaining fraction per sample for exponential ones
+      DataType step;
+      ParameterSmoothing smoothing;
+      gsl::index remaining_samples;
+    };
+    /// Parameter changes sent by another thread, applied at the beginning of the next sample
+    mutable ParameterQueue<DataType> parameter_queue;
+    /// Parameters being smoothed, the capacity is reserved so that new ramps don't allocate
+    mutable std::vector<ParameterRamp> parameter_ramps;
+
   public:
     /**
      * The main ModellerFilter constructor
@@ -70,6 +256,17 @@ namespace ATK
     
     /// Explicit destructor to avoid more than a forward declaration of Component
     ~DynamicModellerFilter();
+
+    /**
+     * Returns a new modeller with copies of the components, the same settings and the same state
+     * The steady state is not computed again, so that the new modeller can process right away
+     * The factorization kept by the chord method or the linear solve is copied with its updates, so that the new modeller iterates the same way
+     * Parameter changes that are waiting or being smoothed are not copied
+     * Throws the RuntimeError of a component that can't be cloned
+     */
+    std::unique_ptr<ModellerFilter<DataType>> clone() const override;
+    /// Same as clone(), with the actual type of the new modeller
+    std::unique_ptr<DynamicModellerFilter> clone_dynamic() const;
     
     using Pin = std::tuple<PinType, gsl::index>;
     
@@ -171,10 +368,184 @@ namespace ATK
     /// Set the value of a parameter
     void set_parameter(gsl::index identifier, DataType_ value) override;
 
+    /// Returns a direct access to a parameter, valid as long as the components of this modeller
+    ParameterHandle<DataType> get_parameter_handle(gsl::index identifier) const;
+    /// Returns a direct access to the first parameter with this name
+    ParameterHandle<DataType> get_parameter_handle(const std::string& name) const;
+
+    /**
+     * Sets the value of a parameter without looking for its component, not to be called during processing
+     * @param handle is the parameter, obtained from this modeller
+     * @param value is the new value
+     */
+    void set_parameter(const ParameterHandle<DataType>& handle, DataType value);
+
+    /**
+     * Sends a parameter change to the processing thread, where it is applied at the beginning of the next sample
+     * Can be called during processing from a single other thread, doesn't allocate nor lock
+     * @param handle is the parameter, obtained from this modeller
+     * @param value is the new value
+     * @param smoothing is the transition from the current value
+     * @param samples is the length of a linear ramp or the time constant of an exponential transition, which stops after 10 time constants
+     * @return false if too many changes are waiting, the change is then dropped
+     */
+    bool push_parameter(const ParameterHandle<DataType>& handle, DataType value, ParameterSmoothing smoothing = ParameterSmoothing::None, gsl::index samples = 0);
+
+    /**
+     * Sets the linear solver used for the Newton updates
+     * Contrary to the dense solver, SolverType::Sparse allocates during processing: the numerical factorization and the solve of Eigen::SparseLU use their own temporaries
+     * @param solver_type is the new linear solver
+     */
+    void set_solver_type(SolverType solver_type);
+    /// Gets the linear solver used for the Newton updates
+    SolverType get_solver_type() const;
+
+    /**
+     * Enables the double precision solve of the Newton updates with the dense solver
+     * The components and the jacobian are still computed with DataType, this is only useful in single precision
+     * @param mixed_precision activates the double precision solve
+     */
+    void set_mixed_precision(bool mixed_precision);
+    /// Returns true if the Newton updates are solved in double precision
+    bool get_mixed_precision() const;
+
+    /**
+     * Enables the chord (modified Newton) method: the jacobian factorization is kept across iterations and samples
+     * @param chord_newton enables or disables the method
+     * @param contraction_threshold is the maximum ratio between two successive residuals before a full Newton step is done
+     * @param max_samples is the number of samples after which the jacobian is factorized again anyway
+     */
+    void set_chord_newton(bool chord_newton, DataType contraction_threshold = 0.5, gsl::index max_samples = 32);
+    /// Returns true if the chord method is used
+    bool get_chord_newton() const;
+
+    /**
+     * Sets how the Newton updates are damped
+     * @param newton_strategy is the new strategy
+     */
+    void set_newton_strategy(NewtonStrategy newton_strategy);
+    /// Returns how the Newton updates are damped
+    NewtonStrategy get_newton_strategy() const;
+
+    /**
+     * Sets how the initial guess of the Newton iterations is computed for each sample
+     * If the iterations starting from the extrapolated state are slower than from the previous state, the previous state is used
+     * @param predictor is the extrapolation order
+     */
+    void set_predictor(PredictorType predictor);
+    /// Returns the extrapolation used for the initial guess
+    PredictorType get_predictor() const;
+
+    /**
+     * Enables the SPICE like limitation of the junction voltages of diodes and transistors between two Newton iterations
+     * The limitation starts from the initial state of each solve, and the global clamp of the Newton updates is kept in both cases
+     * The iterations stop on the same criterion with or without the limitation, an iteration with a limited junction never converges
+     * @param junction_limiting activates the limitation
+     */
+    void set_junction_limiting(bool junction_limiting);
+    /// Returns true if the junction voltages are limited
+    bool get_junction_limiting() const;
+
+    /// Returns true if the circuit is linear and solved without Newton iterations
+    bool is_linear() const;
+
+    /**
+     * Enables the gathering of the solver statistics during processing
+     * @param statistics_enabled activates the statistics
+     */
+    void enable_statistics(bool statistics_enabled);
+    /// Returns true if the solver statistics are gathered
+    bool get_statistics_enabled() const;
+    /**
+     * Returns the solver statistics of the last processed block
+     * Can be called from any thread, the statistics are published without locking the processing thread
+     */
+    SolverStatistics<DataType> get_statistics() const;
+
+    /**
+     * Sets a real time budget for each processed block
+     * When the budget of a block runs low, the remaining samples are solved with a fixed number of iterations and the best state found is kept
+     * @param iterations_per_sample is the mean number of Newton iterations allowed per sample, 0 to disable. The final evaluation of the state of a sample counts as an iteration
+     * @param nanoseconds_per_sample is the mean processing time allowed per sample, 0 to disable
+     * @param degraded_iterations is the number of iterations per sample once the budget is exhausted
+     */
+    void set_realtime_budget(double iterations_per_sample, double nanoseconds_per_sample = 0, gsl::index degraded_iterations = 4);
+    /// Returns the mean number of iterations allowed per sample
+    double get_iterations_budget() const;
+    /// Returns the mean processing time allowed per sample
+    double get_time_budget() const;
+    /// Returns the number of iterations per sample once the budget is exhausted
+    gsl::index get_degraded_iterations() const;
+    /// Returns the number of samples that didn't converge because of the budget, can be called from any thread
+    gsl::index get_nb_degraded_samples() const;
+
+    /**
+     * Sets the maximum number of sub steps used for samples that don't converge
+     * Such a sample is split in 2, 4... sub steps with interpolated inputs until they converge
+     * @param max_substeps is a power of 2, 1 disables sub steps
+     */
+    void set_max_substeps(gsl::index max_substeps);
+    /// Returns the maximum number of sub steps of a sample
+    gsl::index get_max_substeps() const;
+
+    /**
+     * Sets the oversampling factor of the circuit
+     * The inputs are interpolated and the outputs decimated with the same windowed sinc filter of 16 taps per phase during processing
+     * The filters add a latency of 15 input samples for all factors, reported by get_latency()
+     * Their transition band is wide: the output starts to be attenuated around 0.3 times the sampling rate, and the images of the oversampled signal above 0.5 times the sampling rate are not fully rejected, they alias back above about 0.38 times the sampling rate
+     * The steady state is computed again for the new time step
+     * @param oversampling is the new factor, 1 disables oversampling
+     */
+    void set_oversampling(gsl::index oversampling);
+    /// Returns the oversampling factor of the circuit
+    gsl::index get_oversampling() const;
+
+    /**
+     * Sets the cache used by setup() for the steady state
+     * When the circuit is found in the cache, its steady state is restored instead of being computed, otherwise the computed steady state is added to the cache
+     * The cache has to be set before the sampling rates, as they trigger the setup
+     * @param cache is shared with other modellers, nullptr to disable the cache
+     */
+    void set_steady_state_cache(std::shared_ptr<SteadyStateCache<DataType>> cache);
+    /// Returns the cache used for the steady state
+    std::shared_ptr<SteadyStateCache<DataType>> get_steady_state_cache() const;
+
+    /**
+     * Returns the hash identifying the steady state of this circuit in a cache
+     * It is the hash of get_steady_state_description()
+     */
+    std::size_t get_steady_state_key() const;
+    /**
+     * Returns the description of this circuit that is stored with its steady state, and checked when it is found in a cache
+     * It holds the types, pins and values of each component, the static voltages, the initial inputs, the sampling rate and the junction limitation
+     */
+    std::string get_steady_state_description() const;
+
+    /// Returns the size in bytes of a snapshot of the state of the modeller
+    gsl::index get_snapshot_size() const override;
+
+    /**
+     * Writes a binary snapshot of the state of the modeller: voltages, internal states and parameters of the components, extrapolation and oversampling histories
+     * Doesn't allocate, the modeller must be set up
+     * @param buffer receives the snapshot
+     * @param size is the size of the buffer, at least get_snapshot_size()
+     */
+    void save_snapshot(char* buffer, gsl::index size) const override;
+
+    /**
+     * Restores a snapshot written by save_snapshot() by a modeller of the same circuit with the same sampling rate and oversampling
+     * The state is restored in place without allocating, not to be called during processing
+     * Parameter changes that are waiting or being smoothed are dropped, the parameters of the snapshot are used instead
+     * @param buffer is the snapshot
+     * @param size is the size of the snapshot
+     */
+    void restore_snapshot(const char* buffer, gsl::index size) override;
+
     /**
      * Sets up the internal state of the ModellerFilter
+     * @return true if the steady state computation converged
      */
-    void init();
+    bool init();
 
     /**
      * Setups internals
@@ -187,26 +558,257 @@ namespace ATK
     void process_impl(gsl::index size) const override;
     
   private:
+    /**
+     * Allocates the Newton solver workspace and computes where each gradient is stored in the jacobian
+     */
+    void allocate_workspace();
+    /**
+     * Copies the kept factorization of the jacobian and its low rank updates in a clone with an allocated workspace
+     * @param model is the clone
+     */
+    void copy_solver_state(DynamicModellerFilter& model) const;
+
+    /// Returns the number of values of the internal states of all components
+    gsl::index get_component_states_size() const;
+    /// Saves the internal states of all components, in insertion order
+    void save_component_states(DataType* states) const;
+    /// Restores the internal states saved by save_component_states()
+    void restore_component_states(const DataType* states);
+
+    /// Returns a hash of the types and pins of the components, without their values
+    std::size_t get_circuit_key() const;
+
+    /**
+     * Writes the snapshot of the state, or only computes its size
+     * @param buffer receives the snapshot, nullptr to only compute the size
+     * @return the size of the snapshot
+     */
+    gsl::index write_snapshot(char* buffer) const;
+
+    /**
+     * Restores the steady state from the cache
+     * @return false if there is no cache or if the circuit is not in the cache
+     */
+    bool load_steady_state();
+    /// Adds the current steady state to the cache, if there is one, only converged steady states have to be added
+    void store_steady_state() const;
+
+    /**
+     * Computes the sparse jacobian pattern and analyzes it
+     */
+    void analyze_sparse_pattern();
+
+    /**
+     * Returns the offset of the element (row, col) in the jacobian values for the current solver type
+     */
+    gsl::index get_jacobian_slot(gsl::index row, gsl::index col);
+
+    /**
+     * Precomputes all components before computing the equations, the exponentials of the junctions are computed in a batch
+     * @param steady_state indicates if a steady state is requested
+     * @return true if a junction voltage was limited, in which case the iteration cannot be considered converged
+     */
+    bool precompute(bool steady_state) const;
+
+    /**
+     * Precomputes the components that are not junctions and gets the arguments of the exponentials of the junctions
+     * @param steady_state indicates if a steady state is requested
+     * @param values receives the arguments of the exponentials
+     */
+    void gather_exponents(bool steady_state, DataType* values) const;
+
+    /// Saves the exponentials and the limitation history of the junctions in junction_states
+    void save_junction_states() const;
+    /// Restores the junction states saved by save_junction_states()
+    void restore_junction_states() const;
+
+    /**
+     * Starts the junction voltage limitation from the current state, so that the limitation doesn't depend on the iterations of the previous solves
+     */
+    void reset_junction_limiting() const;
+
+    /**
+     * Gives the exponentials back to the junctions
+     * @param values are the exponentials
+     * @return true if a junction voltage was limited
+     */
+    bool scatter_exponentials(const DataType* values) const;
+
+    /**
+     * Applies the waiting parameter changes and moves the smoothed parameters one sample forward
+     */
+    void update_parameters() const;
+
+    /**
+     * Extrapolates the previous states to get the initial guess of the current sample
+     * @return true if the extrapolation is used
+     */
+    bool predict() const;
+
+    /**
+     * Stores the converged state in the history used for extrapolation
+     * @param predicted indicates if the iterations started from the extrapolation
+     * @param iterations is the number of iterations needed for this sample
+     */
+    void update_history(bool predicted, gsl::index iterations) const;
+
+    /**
+     * Computes the new state of a linear circuit with one solve of the prefactorized jacobian
+     */
+    void solve_linear() const;
+
+    /**
+     * Computes the equations and optionally the jacobian for the current state
+     * @param steady_state indicates if a steady state is requested
+     * @param with_jacobian indicates if the jacobian has to be computed as well
+     */
+    void compute_equations(bool steady_state, bool with_jacobian) const;
+
+    /**
+     * Adds the currents and the non constant gradients of all components
+     * @param eqs are the equations to update
+     * @param jacobian_values are the jacobian values to update, nullptr if the jacobian is not computed
+     * @param steady_state indicates if a steady state is requested
+     */
+    void stamp_components(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const;
+
+    /**
+     * Computes the jacobian values of the components with a constant gradient
+     */
+    void compute_constant_jacobian() const;
+
+    /**
+     * Factorizes the current jacobian
+     * @param steady_state indicates if a steady state is requested
+     */
+    void factorize(bool steady_state) const;
+
+    /**
+     * Solves jacobian * delta = eqs with the last factorization of the jacobian and its low rank updates
+     */
+    void solve_delta() const;
+
+    /**
+     * Solves jacobian * delta = eqs with the last factorization of the jacobian only
+     */
+    void solve_factorized_delta() const;
+
+    /**
+     * Changes a parameter, the factorization of the jacobian is updated instead of computed again when the change is low rank
+     * Only the gradients of the currents are considered, custom equations must not depend on parameters
+     * @param handle is the parameter to change
+     * @param value is its new value
+     */
+    void change_parameter(const ParameterHandle<DataType>& handle, DataType value) const;
+
+    /**
+     * Adds a change of the gradients of a component as rank one updates of the factorization
+     * @param component is the changed component
+     * @param gradients_delta is the change of its gradients, by pin_index_ref then pin_index
+     * @return false if too many updates were done, the jacobian must then be factorized again
+     */
+    template<typename Matrix>
+    bool add_low_rank_update(const Component<DataType>* component, Matrix gradients_delta) const;
+
+    /**
+     * Adds a rank one update U V^T of the factorization, with U in eqs and V in delta
+     * @param component is the changed component, its updates are merged when V is the same
+     * @return false if too many updates were done or if the updated jacobian is singular
+     */
+    bool add_rank_one_update(const Component<DataType>* component) const;
+
+    /**
+     * Computes the QR decomposition of the dense jacobian, in double precision if requested
+     */
+    void factorize_dense() const;
+
+    /**
+     * Solves jacobian * delta = eqs with the current QR decomposition of the jacobian, without allocating
+     */
+    void solve_dense_delta() const;
+
     /**
      * Solve the state of the ModellerFilter
      * @param steady_state indicates if a steady state is requested
+     * @param max_iterations is the maximum number of iterations, the best state is kept if the iterations are stopped before MAX_ITERATION
+     * @return the number of iterations that were needed, max_iterations if the iterations didn't converge
+     */
+    gsl::index solve(bool steady_state, gsl::index max_iterations) const;
+
+    /**
+     * Solves the two halves of a part of the current sample, each half is split again if it doesn't converge
+     * The state must be the converged state at the beginning of the part
+     * @param start is the beginning of the part, as a fraction of the sample
+     * @param end is the end of the part, as a fraction of the sample
+     * @param depth is the level of the halves
+     * @param iterations is incremented by the number of iterations of each sub step
+     * @return true if all sub steps converged
+     */
+    bool solve_substeps(DataType start, DataType end, gsl::index depth, gsl::index& iterations) const;
+
+    /**
+     * Returns the time step of the circuit, oversampling included
+     */
+    DataType get_circuit_time_step() const;
+
+    /**
+     * Computes the up and down sampling filters and fills their history with the current state
+     */
+    void setup_oversampling();
+
+    /**
+     * Changes the time step of the components, the state must be the last converged state
+     * @param dt is the new time step
+     */
+    void set_time_step(DataType dt) const;
+
+    /**
+     * Computes the maximum number of iterations of the next sample so that the block stays in its budget
+     * @param remaining_samples is the number of samples left in the block, including the next one
+     * @param block_iterations is the number of iterations already done in the block
+     * @param block_size is the size of the block
+     * @param start is the time when the block processing started
+     */
+    gsl::index get_max_iterations(gsl::index remaining_samples, gsl::index block_iterations, gsl::index block_size, std::chrono::steady_clock::time_point start) const;
+
+    /**
+     * Applies the Newton update with a backtracking line search
+     * @param steady_state indicates if a steady state is requested
+     * @param residual is the norm of the equations before the update
      */
-    void solve(bool steady_state) const;
+    void line_search(bool steady_state, DataType residual) const;
+
+    /**
+     * Applies the Newton update after limiting its biggest element to MAX_DELTA
+     */
+    void clamped_update() const;
 
     /**
      * One iteration for the solver
      * @param steady_state indicates if a steady state is requested
      */
     bool iterate(bool steady_state) const;
-    
+
     /**
-     * Retrieve all currents for a given pin and the corresponding jacobian
-     * @param i is the pin to update
-     * @param eqs is the full equation state, only one element will be updated
-     * @params jacobian is the full jacobian, but only one line will be updated
+     * One iteration for the solver, once the components are precomputed
      * @param steady_state indicates if a steady state is requested
+     * @param limited indicates if a junction voltage was limited during the precomputation
+     */
+    bool iterate_precomputed(bool steady_state, bool limited) const;
+
+    /**
+     * Applies the parameter changes and prepares the solve of a new sample once the inputs are set
+     * @return true if the iterations start from the extrapolation of the last states
+     */
+    bool start_sample() const;
+
+    /**
+     * Updates the components and the history after the solve of a sample
+     * @param predicted indicates if the iterations started from the extrapolation
+     * @param iterations is the number of iterations of the sample
      */
-    void compute_current(gsl::index i, Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>& jacobian, bool steady_state) const;
+    void finish_sample(bool predicted, gsl::index iterations) const;
+
   };
 }
 
@@ -0,0 +1,190 @@
+/**
+ * \file ExponentialControlledCurrent.cpp
+ */
+
+#include "DynamicModellerFilter.h"
+#include "ExponentialControlledCurrent.h"
+#include "StaticJunction.h"
+#include "ValueDescription.h"
+
+#include <ATK/Core/Utilities.h>
+#include <ATK/Utility/fmath.h>
+
+namespace ATK
+{
+  template<typename DataType_>
+  ExponentialControlledCurrent<DataType_>::ExponentialControlledCurrent(DataType_ Is, DataType_ Vt)
+  :Is(Is), Vt(Vt), x_crit(junction_critical_voltage(Is, Vt))
+  {
+  }
+
+  template<typename DataType_>
+  DataType_ ExponentialControlledCurrent<DataType_>::get_output_current() const
+  {
+    DataType current = Is * precomp;
+    if(limited_voltage != 0)
+    {
+      // Linearization of the current around the limited voltage
+      current += get_output_gradient() * limited_voltage;
+    }
+    return current;
+  }
+
+  template<typename DataType_>
+  DataType_ ExponentialControlledCurrent<DataType_>::get_output_gradient() const
+  {
+    return Is / Vt * precomp;
+  }
+
+  template<typename DataType_>
+  DataType_ ExponentialControlledCurrent<DataType_>::get_current(gsl::index pin_index, bool steady_state) const
+  {
+    switch(pin_index)
+    {
+      case 2:
+        return -get_output_current();
+      case 3:
+        return get_output_current();
+      default:
+        return 0;
+    }
+  }
+  
+  template<typename DataType_>
+  DataType_ ExponentialControlledCurrent<DataType_>::get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const
+  {
+    if(pin_index_ref < 2 || pin_index > 1)
+    {
+      return 0;
+    }
+    return get_output_gradient() * (2 == pin_index_ref ? -1 : 1) * (0 == pin_index ? 1 : -1);
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    Parent::stamp_transconductance(eqs, jacobian_values, get_output_current(), get_output_gradient());
+  }
+  
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::precompute(bool steady_state)
+  {
+    DataType exponent;
+    get_exponents(&exponent);
+    precomp = fmath::exp(exponent);
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::get_exponents(DataType* exponents)
+  {
+    DataType x = (modeller->retrieve_voltage(pins[0]) - modeller->retrieve_voltage(pins[1])) / Vt;
+    // An input or static control voltage is exact, limiting it would only delay the convergence
+    if(!limiting || (std::get<0>(pins[0]) != PinType::Dynamic && std::get<0>(pins[1]) != PinType::Dynamic))
+    {
+      exponents[0] = x;
+      return;
+    }
+    DataType x_limited = limit_junction_voltage(x, x_old, x_crit);
+    x_old = x_limited;
+    limited_voltage = (x - x_limited) * Vt;
+    exponents[0] = x_limited;
+  }
+  
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::set_exponentials(const DataType* values)
+  {
+    precomp = values[0];
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::set_junction_limiting(bool limiting)
+  {
+    this->limiting = limiting;
+    limited_voltage = 0;
+  }
+
+  template<typename DataType_>
+  bool ExponentialControlledCurrent<DataType_>::is_limited() const
+  {
+    return limited_voltage != 0;
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::reset_junction_limiting()
+  {
+    x_old = (modeller->retrieve_voltage(pins[0]) - modeller->retrieve_voltage(pins[1])) / Vt;
+    limited_voltage = 0;
+  }
+
+  template<typename DataType_>
+  gsl::index ExponentialControlledCurrent<DataType_>::get_number_parameters() const
+  {
+    return 1;
+  }
+
+  template<typename DataType_>
+  std::string ExponentialControlledCurrent<DataType_>::get_parameter_name(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return "Is";
+  }
+
+  template<typename DataType_>
+  DataType_ ExponentialControlledCurrent<DataType_>::get_parameter(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return Is;
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::set_parameter(gsl::index identifier, DataType_ value)
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    Is = value;
+    x_crit = junction_critical_voltage(Is, Vt);
+  }
+
+  template<typename DataType_>
+  gsl::index ExponentialControlledCurrent<DataType_>::get_state_size() const
+  {
+    return 2;
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::save_state(DataType* state) const
+  {
+    state[0] = precomp;
+    state[1] = x_old;
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::restore_state(const DataType* state)
+  {
+    precomp = state[0];
+    x_old = state[1];
+  }
+
+  template<typename DataType_>
+  void ExponentialControlledCurrent<DataType_>::append_values(std::string& description) const
+  {
+    append_bytes(description, Is, Vt);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> ExponentialControlledCurrent<DataType_>::clone() const
+  {
+    return std::make_unique<ExponentialControlledCurrent<DataType_>>(*this);
+  }
+
+  template class ExponentialControlledCurrent<float>;
+  template class ExponentialControlledCurrent<double>;
+}
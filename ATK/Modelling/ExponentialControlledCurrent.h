@@ -0,0 +1,131 @@
+/**
+ * \file ExponentialControlledCurrent.h
+ */
+
+#ifndef ATK_MODELLING_EXPONENTIALCONTROLLEDCURRENT_H
+#define ATK_MODELLING_EXPONENTIALCONTROLLEDCURRENT_H
+
+#include "Component.h"
+
+namespace ATK
+{
+  /**
+   * Current generator controlled by a voltage, the current is exponential in the control voltage like in an expo converter
+   * The first two pins are the control pins, usually input or static pins, the current flows from the third pin to the fourth one
+   */
+  template<typename DataType_>
+  class ATK_MODELLING_EXPORT ExponentialControlledCurrent final: public Component<DataType_>
+  {
+  public:
+    using Parent = Component<DataType_>;
+    using DataType = DataType_;
+
+    /**
+     * Constructor
+     * @param Is is the current for a null control voltage
+     * @param Vt is the control voltage that multiplies the current by e
+     */
+    ExponentialControlledCurrent(DataType Is, DataType Vt = 26e-3);
+    
+    /**
+     * Get current for the given pin based on the state
+     * @param pin_index is the pin from which to compute the current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType get_current(gsl::index pin_index, bool steady_state) const override;
+    
+    /**
+     * Get current gradient for the given pins based on the state
+     * @param pin_index_ref is the pin of the current from which the gradient is computed
+     * @param pin_index is the pin from which to compute the gradient of the pin_index current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// Returns the number of values saved by save_state()
+    gsl::index get_state_size() const override;
+    /// Saves the exponential and the control voltage of the last iteration
+    void save_state(DataType* state) const override;
+    /// Restores the exponential and the control voltage of the last iteration
+    void restore_state(const DataType* state) override;
+    /// Appends the current for a null control voltage and Vt to a description
+    void append_values(std::string& description) const override;
+
+    /**
+     * Adds the currents and gradients of this component to the equations and the jacobian
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const override;
+    
+    /**
+     * Precompute internal value before asking current and gradients
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void precompute(bool steady_state) override;
+    
+    /// Number of exponentials computed by precompute
+    static constexpr gsl::index nb_exponentials = 1;
+    
+    /**
+     * Stores the arguments of the exponentials of precompute, so that they can be computed in a batch
+     * @param exponents is where the nb_exponentials arguments are stored
+     */
+    void get_exponents(DataType* exponents);
+    
+    /**
+     * Finishes the precomputation with the batched exponentials
+     * @param values are the exponentials of the arguments returned by get_exponents
+     */
+    void set_exponentials(const DataType* values);
+
+    /**
+     * Enables the limitation of the control voltage variation between two Newton iterations
+     * Only a control voltage that depends on dynamic pins is limited
+     * @param limiting activates the limitation
+     */
+    void set_junction_limiting(bool limiting);
+    
+    /// Returns true if the control voltage was limited during the last precomputation
+    bool is_limited() const;
+
+    /// Starts the limitation of the next iterations from the control voltage of the current state
+    void reset_junction_limiting();
+
+    /// The current for a null control voltage is the only parameter
+    gsl::index get_number_parameters() const override;
+    /// Returns "Is"
+    std::string get_parameter_name(gsl::index identifier) const override;
+    /// Returns the current for a null control voltage
+    DataType_ get_parameter(gsl::index identifier) const override;
+    /// Changes the current for a null control voltage
+    void set_parameter(gsl::index identifier, DataType_ value) override;
+
+  private:
+    /// Returns the current flowing from the third pin to the fourth one
+    DataType get_output_current() const;
+    /// Returns the gradient of this current against the control voltage
+    DataType get_output_gradient() const;
+
+    DataType Is;
+    DataType Vt;
+    /// Exponential of the control voltage divided by Vt
+    DataType precomp = 1;
+    bool limiting = false;
+    DataType x_crit;
+    /// Control voltage of the previous iteration, divided by Vt
+    DataType x_old = 0;
+    /// Difference between the actual and the limited control voltage
+    DataType limited_voltage = 0;
+
+  protected:
+    using Parent::modeller;
+    using Parent::pins;
+  };
+}
+
+#endif
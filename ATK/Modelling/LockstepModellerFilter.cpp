@@ -0,0 +1,526 @@
+/**
+ * \file LockstepModellerFilter.cpp
+ */
+
+#include "Component.h"
+#include "LockstepModellerFilter.h"
+
+#include <ATK/Core/Utilities.h>
+
+#include <limits>
+
+namespace ATK
+{
+  template<typename DataType_>
+  LockstepModellerFilter<DataType_>::LockstepModellerFilter(const DynamicModellerFilter<DataType>& model, gsl::index nb_lanes)
+  : Parent(model.get_nb_input_pins() * nb_lanes, model.get_nb_dynamic_pins() * nb_lanes)
+  , nb_lane_inputs(model.get_nb_input_pins())
+  , nb_lane_outputs(model.get_nb_dynamic_pins())
+  , nb_pins(model.get_nb_dynamic_pins())
+  , iterations(nb_lanes)
+  , predicted(nb_lanes)
+  , active(nb_lanes)
+  , limited(nb_lanes)
+  , singular(nb_lanes)
+  {
+    if(nb_lanes < 1)
+    {
+      throw RuntimeError("A lockstep modeller needs at least one instance");
+    }
+    if(model.get_oversampling() != 1)
+    {
+      throw RuntimeError("Oversampled modellers can't be solved in lockstep");
+    }
+    if(model.get_chord_newton() || model.get_newton_strategy() != NewtonStrategy::Clamped)
+    {
+      throw RuntimeError("Modellers with the chord method or a line search can't be solved in lockstep");
+    }
+    for(gsl::index i = 0; i < nb_lanes; ++i)
+    {
+      lanes.push_back(model.clone_dynamic());
+    }
+  }
+
+  template<typename DataType_>
+  LockstepModellerFilter<DataType_>::~LockstepModellerFilter()
+  {
+  }
+
+  template<typename DataType_>
+  gsl::index LockstepModellerFilter<DataType_>::get_nb_lanes() const
+  {
+    return lanes.size();
+  }
+
+  template<typename DataType_>
+  DynamicModellerFilter<DataType_>& LockstepModellerFilter<DataType_>::get_lane(gsl::index lane)
+  {
+    return *lanes[lane];
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::setup()
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+
+    gsl::index nb_lanes = lanes.size();
+    gsl::index nb_exponents = 0;
+    for(auto& lane: lanes)
+    {
+      lane->set_input_sampling_rate(input_sampling_rate);
+      lane->set_output_sampling_rate(output_sampling_rate);
+      // Parameter changes have to invalidate the constant jacobian, they can't be low rank updates of a factorization
+      lane->factorization_valid = false;
+      nb_exponents += lane->exponents.size();
+    }
+    exponents.setZero(nb_exponents);
+    exponents_offsets.assign(nb_lanes, 0);
+
+    // The coefficients of all instances are interleaved, so that each coefficient of all the instances is contiguous
+    current_slots.clear();
+    gradient_slots.clear();
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      const auto& model = *lanes[lane];
+      for(const auto& component: model.components)
+      {
+        const auto& pins = component->get_pins();
+        std::vector<gsl::index> lane_current_slots(pins.size(), -1);
+        std::vector<gsl::index> lane_gradient_slots(pins.size() * pins.size(), -1);
+        for(gsl::index i = 0; i < pins.size(); ++i)
+        {
+          // Currents are only added on Kirchhoff equations
+          if(std::get<0>(pins[i]) != PinType::Dynamic || std::get<0>(model.dynamic_pins_equation[std::get<1>(pins[i])]) != nullptr)
+          {
+            continue;
+          }
+          lane_current_slots[i] = std::get<1>(pins[i]) * nb_lanes + lane;
+          for(gsl::index j = 0; j < pins.size(); ++j)
+          {
+            if(std::get<0>(pins[j]) == PinType::Dynamic)
+            {
+              lane_gradient_slots[i * pins.size() + j] = (std::get<1>(pins[j]) * nb_pins + std::get<1>(pins[i])) * nb_lanes + lane;
+            }
+          }
+        }
+        current_slots.push_back(std::move(lane_current_slots));
+        gradient_slots.push_back(std::move(lane_gradient_slots));
+      }
+    }
+    custom_equations.clear();
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      if(std::get<0>(lanes.front()->dynamic_pins_equation[i]) != nullptr)
+      {
+        custom_equations.push_back(i);
+      }
+    }
+
+    states.setZero(nb_lanes, nb_pins);
+    deltas.setZero(nb_lanes, nb_pins);
+    equations.setZero(nb_lanes * nb_pins);
+    jacobians.setZero(nb_lanes, nb_pins * nb_pins);
+    constant_jacobians.setZero(nb_lanes, nb_pins * nb_pins);
+    pivots.assign(nb_lanes * nb_pins, 0);
+    factorization_valid = false;
+    lane_values.setZero(nb_lanes);
+    lane_rows.setZero(nb_lanes);
+    lane_steps.setZero(nb_lanes);
+    for(auto& lane: lanes)
+    {
+      lane->constant_jacobian_valid = false;
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      for(gsl::index lane = 0; lane < lanes.size(); ++lane)
+      {
+        for(gsl::index j = 0; j < nb_lane_inputs; ++j)
+        {
+          lanes[lane]->input_state[j] = converted_inputs[lane * nb_lane_inputs + j][i];
+        }
+      }
+
+      solve_lanes();
+
+      for(gsl::index lane = 0; lane < lanes.size(); ++lane)
+      {
+        lanes[lane]->finish_sample(predicted[lane], iterations[lane]);
+        for(gsl::index j = 0; j < nb_lane_outputs; ++j)
+        {
+          outputs[lane * nb_lane_outputs + j][i] = lanes[lane]->dynamic_state[j];
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::solve_lanes() const
+  {
+    for(gsl::index lane = 0; lane < lanes.size(); ++lane)
+    {
+      const auto& model = *lanes[lane];
+      predicted[lane] = model.start_sample();
+      iterations[lane] = 0;
+      singular[lane] = false;
+      states.row(lane) = model.dynamic_state.transpose();
+    }
+    // The constant jacobians are computed with the slots of the instances
+    update_constant_jacobians();
+
+    swap_slots();
+    if(lanes.front()->linear)
+    {
+      solve_linear_lanes();
+    }
+    else
+    {
+      iterate_lanes();
+    }
+    swap_slots();
+
+    for(gsl::index lane = 0; lane < lanes.size(); ++lane)
+    {
+      const auto& model = *lanes[lane];
+      if(singular[lane])
+      {
+        iterations[lane] = model.solve(false, DynamicModellerFilter<DataType>::MAX_ITERATION);
+      }
+      // Instances that didn't converge get the sub steps of their own solver
+      if(iterations[lane] == DynamicModellerFilter<DataType>::MAX_ITERATION && !model.linear && model.max_substep_depth > 0)
+      {
+        model.dynamic_state = model.substep_states.col(0);
+        model.solve_substeps(0, 1, 1, iterations[lane]);
+      }
+      model.factorization_valid = false;
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::iterate_lanes() const
+  {
+    gsl::index nb_lanes = lanes.size();
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      const auto& model = *lanes[lane];
+      active[lane] = true;
+      if(model.junction_limiting)
+      {
+        model.reset_junction_limiting();
+      }
+    }
+
+    bool any_active = true;
+    while(any_active)
+    {
+      // The exponentials of all the instances that are still iterating are packed and computed together
+      gsl::index nb_exponents = 0;
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        if(active[lane])
+        {
+          exponents_offsets[lane] = nb_exponents;
+          lanes[lane]->gather_exponents(false, exponents.data() + nb_exponents);
+          nb_exponents += lanes[lane]->exponents.size();
+        }
+      }
+      exponents.head(nb_exponents) = exponents.head(nb_exponents).exp();
+
+      equations.setZero();
+      jacobians = constant_jacobians;
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        if(active[lane])
+        {
+          limited[lane] = lanes[lane]->scatter_exponentials(exponents.data() + exponents_offsets[lane]);
+          compute_equations(lane, true);
+        }
+      }
+
+      // Check if the equations have converged, the equations of limited junctions are only approximations
+      lane_values = Eigen::Map<const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>(equations.data(), nb_lanes, nb_pins).cwiseAbs().rowwise().maxCoeff().array();
+      any_active = false;
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        if(active[lane] && !limited[lane] && lane_values(lane) < DynamicModellerFilter<DataType>::EPS)
+        {
+          active[lane] = false;
+        }
+        any_active |= active[lane] != 0;
+      }
+      if(!any_active)
+      {
+        break;
+      }
+
+      // The instances that have converged are decomposed as well, it costs less than gathering the others
+      factorize();
+      solve_deltas();
+
+      lane_values = deltas.cwiseAbs().rowwise().maxCoeff().array();
+      any_active = false;
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        lane_steps(lane) = 0;
+        if(!active[lane])
+        {
+          continue;
+        }
+        // Written so that NaN updates are caught as well
+        if(!(lane_values(lane) <= std::numeric_limits<DataType>::max()))
+        {
+          singular[lane] = true;
+          active[lane] = false;
+          continue;
+        }
+        // Check if the update is big enough
+        if(!limited[lane] && lane_values(lane) < DynamicModellerFilter<DataType>::EPS)
+        {
+          active[lane] = false;
+          continue;
+        }
+        lane_steps(lane) = lane_values(lane) > DynamicModellerFilter<DataType>::MAX_DELTA ? static_cast<DataType>(DynamicModellerFilter<DataType>::MAX_DELTA) / lane_values(lane) : 1;
+        if(++iterations[lane] == DynamicModellerFilter<DataType>::MAX_ITERATION)
+        {
+          active[lane] = false;
+        }
+        any_active |= active[lane] != 0;
+      }
+
+      // Clamped updates of all instances, the ones that don't iterate anymore have a null step
+      states.noalias() -= lane_steps.matrix().asDiagonal() * deltas;
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        if(lane_steps(lane) != 0)
+        {
+          lanes[lane]->dynamic_state = states.row(lane).transpose();
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::solve_linear_lanes() const
+  {
+    gsl::index nb_lanes = lanes.size();
+    equations.setZero();
+    if(!factorization_valid)
+    {
+      jacobians = constant_jacobians;
+    }
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      lanes[lane]->precompute(false);
+      compute_equations(lane, !factorization_valid);
+    }
+    // The jacobians are constant, they are only decomposed again after a parameter change
+    if(!factorization_valid)
+    {
+      factorize();
+      factorization_valid = true;
+    }
+    solve_deltas();
+    states -= deltas;
+
+    lane_values = deltas.cwiseAbs().rowwise().maxCoeff().array();
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      const auto& model = *lanes[lane];
+      if(!(lane_values(lane) <= std::numeric_limits<DataType>::max()))
+      {
+        singular[lane] = true;
+        continue;
+      }
+      model.dynamic_state = states.row(lane).transpose();
+      // Coils update their state from the current they precomputed, it has to be the current of the solution
+      model.precompute(false);
+      iterations[lane] = 1;
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::update_constant_jacobians() const
+  {
+    gsl::index nb_lanes = lanes.size();
+    gsl::index slot_index = 0;
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      const auto& model = *lanes[lane];
+      if(model.constant_jacobian_valid)
+      {
+        slot_index += model.components.size();
+        continue;
+      }
+      // The instance keeps its own constant jacobian for its sub steps
+      model.compute_constant_jacobian();
+      constant_jacobians.row(lane).setZero();
+      for(const auto& component: model.components)
+      {
+        const auto& slots = gradient_slots[slot_index++];
+        if(!component->has_constant_gradient())
+        {
+          continue;
+        }
+        gsl::index nb_component_pins = component->get_pins().size();
+        for(gsl::index i = 0; i < nb_component_pins; ++i)
+        {
+          for(gsl::index j = 0; j < nb_component_pins; ++j)
+          {
+            auto slot = slots[i * nb_component_pins + j];
+            if(slot != -1)
+            {
+              constant_jacobians.data()[slot] += component->get_gradient(i, j, false);
+            }
+          }
+        }
+      }
+      factorization_valid = false;
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::swap_slots() const
+  {
+    gsl::index slot_index = 0;
+    for(const auto& lane: lanes)
+    {
+      for(const auto& component: lane->components)
+      {
+        component->swap_slots(current_slots[slot_index], gradient_slots[slot_index]);
+        ++slot_index;
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::compute_equations(gsl::index lane, bool with_jacobian) const
+  {
+    const auto& model = *lanes[lane];
+    model.stamp_components(equations, with_jacobian ? jacobians.data() : nullptr, false);
+    // Custom equations are computed in the dense workspace of the instance and then copied in the shared ones
+    gsl::index nb_lanes = lanes.size();
+    for(auto i: custom_equations)
+    {
+      model.jacobian.row(i).setZero();
+      std::get<0>(model.dynamic_pins_equation[i])->add_equation(i, std::get<1>(model.dynamic_pins_equation[i]), model.eqs, model.jacobian, false);
+      equations(i * nb_lanes + lane) = model.eqs(i);
+      if(with_jacobian)
+      {
+        for(gsl::index j = 0; j < nb_pins; ++j)
+        {
+          jacobians(lane, j * nb_pins + i) = model.jacobian(i, j);
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::factorize() const
+  {
+    gsl::index nb_lanes = lanes.size();
+    for(gsl::index k = 0; k < nb_pins; ++k)
+    {
+      // Each instance selects the biggest coefficient of its column
+      lane_values = jacobians.col(k * nb_pins + k).array().abs();
+      lane_rows.setConstant(k);
+      for(gsl::index row = k + 1; row < nb_pins; ++row)
+      {
+        lane_rows = (jacobians.col(k * nb_pins + row).array().abs() > lane_values).select(static_cast<DataType>(row), lane_rows);
+        lane_values = lane_values.max(jacobians.col(k * nb_pins + row).array().abs());
+      }
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        auto pivot = static_cast<gsl::index>(lane_rows(lane));
+        pivots[k * nb_lanes + lane] = pivot;
+        if(pivot != k)
+        {
+          for(gsl::index col = 0; col < nb_pins; ++col)
+          {
+            std::swap(jacobians(lane, col * nb_pins + k), jacobians(lane, col * nb_pins + pivot));
+          }
+        }
+      }
+
+      // The elimination is done for all instances at once, the loops on the instances are vectorized
+      DataType* pivot_inverses = &jacobians(0, k * nb_pins + k);
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        pivot_inverses[lane] = 1 / pivot_inverses[lane];
+      }
+      for(gsl::index row = k + 1; row < nb_pins; ++row)
+      {
+        DataType* factors = &jacobians(0, k * nb_pins + row);
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          factors[lane] *= pivot_inverses[lane];
+        }
+      }
+      for(gsl::index col = k + 1; col < nb_pins; ++col)
+      {
+        const DataType* pivot_row = &jacobians(0, col * nb_pins + k);
+        for(gsl::index row = k + 1; row < nb_pins; ++row)
+        {
+          const DataType* factors = &jacobians(0, k * nb_pins + row);
+          DataType* values = &jacobians(0, col * nb_pins + row);
+          for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+          {
+            values[lane] -= factors[lane] * pivot_row[lane];
+          }
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void LockstepModellerFilter<DataType_>::solve_deltas() const
+  {
+    gsl::index nb_lanes = lanes.size();
+    deltas = Eigen::Map<const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>(equations.data(), nb_lanes, nb_pins);
+    for(gsl::index k = 0; k < nb_pins; ++k)
+    {
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        std::swap(deltas(lane, k), deltas(lane, pivots[k * nb_lanes + lane]));
+      }
+    }
+    // Forward substitution with the unit lower triangle, then backward substitution with the upper one
+    for(gsl::index k = 0; k < nb_pins; ++k)
+    {
+      const DataType* solved = &deltas(0, k);
+      for(gsl::index row = k + 1; row < nb_pins; ++row)
+      {
+        const DataType* factors = &jacobians(0, k * nb_pins + row);
+        DataType* values = &deltas(0, row);
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          values[lane] -= factors[lane] * solved[lane];
+        }
+      }
+    }
+    for(gsl::index k = nb_pins - 1; k >= 0; --k)
+    {
+      DataType* solved = &deltas(0, k);
+      const DataType* pivot_inverses = &jacobians(0, k * nb_pins + k);
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        solved[lane] *= pivot_inverses[lane];
+      }
+      for(gsl::index row = 0; row < k; ++row)
+      {
+        const DataType* factors = &jacobians(0, k * nb_pins + row);
+        DataType* values = &deltas(0, row);
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          values[lane] -= factors[lane] * solved[lane];
+        }
+      }
+    }
+  }
+
+  template class LockstepModellerFilter<float>;
+  template class LockstepModellerFilter<double>;
+}
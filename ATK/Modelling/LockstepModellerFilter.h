@@ -0,0 +1,151 @@
+/**
+ * \file LockstepModellerFilter.h
+ */
+
+#ifndef ATK_MODELLING_LOCKSTEPMODELLERFILTER_H
+#define ATK_MODELLING_LOCKSTEPMODELLERFILTER_H
+
+#include <memory>
+#include <vector>
+
+#include <ATK/Core/TypedBaseFilter.h>
+
+#include <gsl/gsl>
+
+#include <Eigen/Eigen>
+
+#include "config.h"
+#include "DynamicModellerFilter.h"
+
+namespace ATK
+{
+  /**
+   * Several instances (voices, channels) of the same circuit solved in lockstep
+   * Each sample, the Newton iterations of all instances progress together. The exponentials of all their junctions are computed in a single batch,
+   * and their states, equations and jacobians are stored with one row per instance, so that each coefficient of all the instances is contiguous.
+   * The jacobians of all instances are decomposed together by a LU decomposition with partial pivoting: each instance selects its own pivots, the eliminations are done for all of them at once.
+   * An instance stops iterating as soon as it has converged, the others keep on iterating. The Newton updates are clamped as with NewtonStrategy::Clamped.
+   * The solver type, the mixed precision, the real time budget and the statistics of the instances are not used. Instances with a singular jacobian are solved by their own solver.
+   * The input ports are the input pins of the first instance, then of the second one... and the same for the output ports.
+   */
+  template<typename DataType_>
+  class ATK_MODELLING_EXPORT LockstepModellerFilter: public TypedBaseFilter<DataType_>
+  {
+  public:
+    using Parent = TypedBaseFilter<DataType_>;
+    using DataType = DataType_;
+
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+
+  private:
+    /// The instances of the circuit
+    std::vector<std::unique_ptr<DynamicModellerFilter<DataType>>> lanes;
+    gsl::index nb_lane_inputs;
+    gsl::index nb_lane_outputs;
+
+    /// Number of dynamic pins of an instance
+    gsl::index nb_pins = 0;
+    /// Slots of the components of all instances in the shared equations and jacobians, exchanged with their own slots during the iterations
+    mutable std::vector<std::vector<gsl::index>> current_slots;
+    mutable std::vector<std::vector<gsl::index>> gradient_slots;
+    /// Pins with a custom equation
+    std::vector<gsl::index> custom_equations;
+
+    /// Arguments of the exponentials of the instances still iterating, and the offset of each of these instances
+    mutable Eigen::Array<DataType, Eigen::Dynamic, 1> exponents;
+    mutable std::vector<gsl::index> exponents_offsets;
+
+    /// States and Newton updates of all instances, one row per instance
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> states;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> deltas;
+    /// Equations of all instances, by pin then instance
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, 1> equations;
+    /// Jacobians of all instances, one row per instance with the coefficients by column then row, and the part of the constant gradients
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> jacobians;
+    mutable Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> constant_jacobians;
+    /// Pivot row of each column of each instance, by column then instance
+    mutable std::vector<gsl::index> pivots;
+    /// The LU decompositions of the linear circuits are kept between samples
+    mutable bool factorization_valid = false;
+    /// Work arrays with one value per instance
+    mutable Eigen::Array<DataType, Eigen::Dynamic, 1> lane_values;
+    mutable Eigen::Array<DataType, Eigen::Dynamic, 1> lane_rows;
+    mutable Eigen::Array<DataType, Eigen::Dynamic, 1> lane_steps;
+
+    /// Iterations state of each instance for the current sample
+    mutable std::vector<gsl::index> iterations;
+    mutable std::vector<char> predicted;
+    mutable std::vector<char> active;
+    mutable std::vector<char> limited;
+    mutable std::vector<char> singular;
+
+  public:
+    /**
+     * The main LockstepModellerFilter constructor
+     * @param model is the circuit to use, it is cloned for each instance with its state
+     * @param nb_lanes is the number of instances
+     */
+    LockstepModellerFilter(const DynamicModellerFilter<DataType>& model, gsl::index nb_lanes);
+
+    /// Explicit destructor to avoid more than a forward declaration of the components
+    ~LockstepModellerFilter();
+
+    /// Returns the number of instances
+    gsl::index get_nb_lanes() const;
+
+    /// Returns one instance, for instance to change its parameters
+    DynamicModellerFilter<DataType>& get_lane(gsl::index lane);
+
+    /**
+     * Setups internals
+     */
+    void setup() override;
+
+    /**
+     * Computes the new states of all instances
+     */
+    void process_impl(gsl::index size) const override;
+
+  private:
+    /**
+     * Runs the Newton iterations of all instances for the current sample
+     */
+    void solve_lanes() const;
+
+    /**
+     * Runs the Newton iterations of the non linear instances, starting from their current states
+     */
+    void iterate_lanes() const;
+
+    /**
+     * Solves the linear instances for the current sample
+     */
+    void solve_linear_lanes() const;
+
+    /**
+     * Computes again the constant part of the jacobians of the instances whose parameters or time step changed
+     */
+    void update_constant_jacobians() const;
+
+    /// Exchanges the slots of the components of all instances between their own equations and the shared ones
+    void swap_slots() const;
+
+    /**
+     * Adds the currents and gradients of the components of an instance to the shared equations and jacobians
+     * @param lane is the instance
+     * @param with_jacobian indicates if the jacobian is assembled as well
+     */
+    void compute_equations(gsl::index lane, bool with_jacobian) const;
+
+    /// Replaces the jacobians of all instances by their LU decompositions, the diagonals keep the inverses of the pivots
+    void factorize() const;
+
+    /// Computes the Newton updates of all instances from their equations and LU decompositions
+    void solve_deltas() const;
+  };
+}
+
+#endif
@@ -10,6 +10,8 @@
 #include "Component.h"
 #include "ModellerFilter.h"
 
+#include <ATK/Core/Utilities.h>
+
 namespace ATK
 {
   template<typename DataType_>
@@ -18,5 +20,30 @@ namespace ATK
   {
   }
 
+  template<typename DataType_>
+  std::unique_ptr<ModellerFilter<DataType_>> ModellerFilter<DataType_>::clone() const
+  {
+    throw RuntimeError("This modeller can't be cloned");
+  }
+
+  template<typename DataType_>
+  gsl::index ModellerFilter<DataType_>::get_snapshot_size() const
+  {
+    throw RuntimeError("This modeller doesn't support snapshots");
+  }
+
+  template<typename DataType_>
+  void ModellerFilter<DataType_>::save_snapshot(char* buffer, gsl::index size) const
+  {
+    throw RuntimeError("This modeller doesn't support snapshots");
+  }
+
+  template<typename DataType_>
+  void ModellerFilter<DataType_>::restore_snapshot(const char* buffer, gsl::index size)
+  {
+    throw RuntimeError("This modeller doesn't support snapshots");
+  }
+
+  template class ModellerFilter<float>;
   template class ModellerFilter<double>;
 }
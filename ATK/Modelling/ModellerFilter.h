@@ -5,6 +5,7 @@
 #ifndef ATK_MODELLING_MODELLERFILTER_H
 #define ATK_MODELLING_MODELLERFILTER_H
 
+#include <memory>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
@@ -35,6 +36,13 @@ namespace ATK
      * @param nb_input_pins is the number of input pins (that will have varying voltage with time)
      */
     ModellerFilter(gsl::index nb_dynamic_pins, gsl::index nb_input_pins);
+
+    /**
+     * Returns a new filter with the same circuit, the same settings and the same state, ready to process
+     * The input ports of the new filter are not connected
+     * The default implementation throws a RuntimeError, for modellers that can't be cloned
+     */
+    virtual std::unique_ptr<ModellerFilter> clone() const;
     
     virtual Eigen::Matrix<DataType, Eigen::Dynamic, 1> get_static_state() const = 0;
     
@@ -67,6 +75,25 @@ namespace ATK
 
     /// Set the value of a parameter
     virtual void set_parameter(gsl::index identifier, DataType_ value) = 0;
+
+    /// Returns the size in bytes of a snapshot of the state of the modeller, the default implementation throws a RuntimeError for modellers without snapshots
+    virtual gsl::index get_snapshot_size() const;
+
+    /**
+     * Writes a binary snapshot of the state of the modeller, which must be set up
+     * The default implementation throws a RuntimeError, for modellers without snapshots
+     * @param buffer receives the snapshot
+     * @param size is the size of the buffer, at least get_snapshot_size()
+     */
+    virtual void save_snapshot(char* buffer, gsl::index size) const;
+
+    /**
+     * Restores a snapshot written by save_snapshot() by a modeller of the same circuit, in place
+     * The default implementation throws a RuntimeError, for modellers without snapshots
+     * @param buffer is the snapshot
+     * @param size is the size of the snapshot
+     */
+    virtual void restore_snapshot(const char* buffer, gsl::index size);
   };
 }
 
@@ -0,0 +1,196 @@
+/**
+ * \file ModellerScheduler.cpp
+ */
+
+#include "ModellerScheduler.h"
+
+#include <algorithm>
+
+#include <ATK/Core/BaseFilter.h>
+#include <ATK/Core/Utilities.h>
+
+namespace
+{
+  /// Number of times an idle worker yields before going to sleep
+  constexpr gsl::index IDLE_SPINS = 1000;
+}
+
+namespace ATK
+{
+  ModellerScheduler::ModellerScheduler(gsl::index nb_threads)
+  {
+    if(nb_threads < 0)
+    {
+      throw RuntimeError("The number of worker threads can't be negative");
+    }
+    next_filters = std::make_unique<std::atomic<gsl::index>[]>(nb_threads + 1);
+    end_filters.assign(nb_threads + 1, 0);
+    for(gsl::index i = 0; i <= nb_threads; ++i)
+    {
+      next_filters[i].store(0, std::memory_order_relaxed);
+    }
+
+    workers.reserve(nb_threads);
+    for(gsl::index i = 0; i < nb_threads; ++i)
+    {
+      workers.emplace_back(&ModellerScheduler::run_worker, this, i + 1);
+    }
+  }
+
+  ModellerScheduler::~ModellerScheduler()
+  {
+    stopping.store(true);
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake_condition.notify_all();
+    for(auto& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  gsl::index ModellerScheduler::get_nb_threads() const
+  {
+    return static_cast<gsl::index>(workers.size());
+  }
+
+  void ModellerScheduler::add_filter(BaseFilter* filter)
+  {
+    wait_idle_workers();
+    filters.push_back(filter);
+    assign_filters();
+  }
+
+  void ModellerScheduler::remove_filter(BaseFilter* filter)
+  {
+    wait_idle_workers();
+    filters.erase(std::remove(filters.begin(), filters.end(), filter), filters.end());
+    assign_filters();
+  }
+
+  gsl::index ModellerScheduler::get_nb_filters() const
+  {
+    return static_cast<gsl::index>(filters.size());
+  }
+
+  void ModellerScheduler::wait_idle_workers() const
+  {
+    while(busy_workers.load() > 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  void ModellerScheduler::assign_filters()
+  {
+    auto nb_participants = static_cast<gsl::index>(end_filters.size());
+    auto nb_filters = static_cast<gsl::index>(filters.size());
+    for(gsl::index i = 0; i < nb_participants; ++i)
+    {
+      end_filters[i] = nb_filters * (i + 1) / nb_participants;
+      next_filters[i].store(end_filters[i], std::memory_order_relaxed);
+    }
+  }
+
+  void ModellerScheduler::process(gsl::index size)
+  {
+    if(filters.empty())
+    {
+      return;
+    }
+
+    failed.store(false, std::memory_order_relaxed);
+    error = nullptr;
+    block_size.store(size, std::memory_order_relaxed);
+    remaining_filters.store(static_cast<gsl::index>(filters.size()), std::memory_order_relaxed);
+    for(gsl::index i = 0; i < static_cast<gsl::index>(end_filters.size()); ++i)
+    {
+      next_filters[i].store(i == 0 ? 0 : end_filters[i - 1], std::memory_order_release);
+    }
+
+    // Sequentially consistent, so that either a worker going to sleep sees the new block, or the block sees the sleeping worker
+    generation.fetch_add(1);
+    if(nb_sleeping_workers.load() > 0)
+    {
+      {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+      }
+      wake_condition.notify_all();
+    }
+
+    process_filters(0);
+    while(remaining_filters.load(std::memory_order_acquire) > 0)
+    {
+      std::this_thread::yield();
+    }
+
+    if(failed.load(std::memory_order_relaxed))
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  void ModellerScheduler::process_filters(gsl::index participant)
+  {
+    auto nb_participants = static_cast<gsl::index>(end_filters.size());
+    for(gsl::index i = 0; i < nb_participants; ++i)
+    {
+      auto owner = (participant + i) % nb_participants;
+      while(true)
+      {
+        auto index = next_filters[owner].fetch_add(1, std::memory_order_acq_rel);
+        if(index >= end_filters[owner])
+        {
+          break;
+        }
+        try
+        {
+          filters[index]->process(block_size.load(std::memory_order_relaxed));
+        }
+        catch(...)
+        {
+          if(!failed.exchange(true, std::memory_order_relaxed))
+          {
+            error = std::current_exception();
+          }
+        }
+        remaining_filters.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    }
+  }
+
+  void ModellerScheduler::run_worker(gsl::index participant)
+  {
+    auto last_generation = generation.load();
+    while(true)
+    {
+      gsl::index spins = 0;
+      while(generation.load() == last_generation && !stopping.load())
+      {
+        if(++spins < IDLE_SPINS)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        ++nb_sleeping_workers;
+        wake_condition.wait(lock, [&]{return generation.load() != last_generation || stopping.load();});
+        --nb_sleeping_workers;
+      }
+      if(stopping.load())
+      {
+        return;
+      }
+      last_generation = generation.load();
+
+      // A late worker must not look at the filters once the block is done, they may be changed
+      ++busy_workers;
+      if(remaining_filters.load() > 0)
+      {
+        process_filters(participant);
+      }
+      --busy_workers;
+    }
+  }
+}
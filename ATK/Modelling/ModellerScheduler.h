@@ -0,0 +1,99 @@
+/**
+ * \file ModellerScheduler.h
+ */
+
+#ifndef ATK_MODELLING_MODELLERSCHEDULER_H
+#define ATK_MODELLING_MODELLERSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gsl/gsl>
+
+#include "config.h"
+
+namespace ATK
+{
+  class BaseFilter;
+
+  /**
+   * Processes independent filter chains (typically one modeller per channel or per plugin) concurrently
+   * The worker threads are spawned once, the filters are split between the workers and the calling thread, and a thread that is done with its share steals the filters of the others.
+   * Processing a block doesn't allocate or wait on a lock, except to wake up workers that went to sleep after a long idle period.
+   * The chains must not share filters, as each filter is processed by a single thread without synchronization.
+   */
+  class ATK_MODELLING_EXPORT ModellerScheduler
+  {
+  private:
+    /// Filters to process, ordered by participant
+    std::vector<BaseFilter*> filters;
+    /// Next filter to process in the share of each participant, the calling thread being participant 0
+    std::unique_ptr<std::atomic<gsl::index>[]> next_filters;
+    /// End of the share of each participant
+    std::vector<gsl::index> end_filters;
+
+    std::vector<std::thread> workers;
+
+    std::atomic<gsl::index> block_size{0};
+    std::atomic<gsl::index> remaining_filters{0};
+    std::atomic<unsigned int> generation{0};
+    std::atomic<gsl::index> nb_sleeping_workers{0};
+    std::atomic<gsl::index> busy_workers{0};
+    std::atomic<bool> stopping{false};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+
+    /// Main loop of a worker thread
+    void run_worker(gsl::index participant);
+    /// Processes the share of a participant then steals from the others until there is nothing left
+    void process_filters(gsl::index participant);
+    /// Splits the filters between the participants
+    void assign_filters();
+    /// Waits until no worker looks at the filters
+    void wait_idle_workers() const;
+
+  public:
+    /**
+     * The main constructor, spawns the worker threads
+     * @param nb_threads is the number of worker threads, the thread calling process() is used as well
+     */
+    explicit ModellerScheduler(gsl::index nb_threads);
+    /// Stops and joins the worker threads
+    ~ModellerScheduler();
+
+    ModellerScheduler(const ModellerScheduler&) = delete;
+    ModellerScheduler& operator=(const ModellerScheduler&) = delete;
+
+    /// Returns the number of worker threads
+    gsl::index get_nb_threads() const;
+
+    /**
+     * Adds a filter to process, usually the last filter of a chain (the modeller or the filter writing its outputs)
+     * Allocates, not to be called while a block is processed
+     * @param filter is the filter to process, it is not owned by the scheduler
+     */
+    void add_filter(BaseFilter* filter);
+    /// Removes a filter, not to be called while a block is processed
+    void remove_filter(BaseFilter* filter);
+    /// Returns the number of filters
+    gsl::index get_nb_filters() const;
+
+    /**
+     * Processes all the filters and returns when they are all done
+     * The first exception thrown by a filter is thrown again once all the others are done
+     * @param size is the number of samples to process
+     */
+    void process(gsl::index size);
+  };
+}
+
+#endif
@@ -23,6 +23,12 @@ namespace ATK
   {
     return 0;
   }
+
+  template<typename DataType_>
+  bool OpAmp<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
   
   template<typename DataType_>
   void OpAmp<DataType_>::update_model(DynamicModellerFilter<DataType>* modeller)
@@ -46,5 +52,12 @@ namespace ATK
     }
   }
 
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> OpAmp<DataType_>::clone() const
+  {
+    return std::make_unique<OpAmp<DataType_>>(*this);
+  }
+
+  template class OpAmp<float>;
   template class OpAmp<double>;
 }
@@ -33,6 +33,12 @@ namespace ATK
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     DataType get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// The gradient of this component only depends on its value
+    bool has_constant_gradient() const override;
     
     /**
      * Used to indicate if the modeller needs to update its set of equations with those provided by this component
@@ -0,0 +1,113 @@
+/**
+ * \file ParameterQueue.h
+ */
+
+#ifndef ATK_MODELLING_PARAMETERQUEUE_H
+#define ATK_MODELLING_PARAMETERQUEUE_H
+
+#include <atomic>
+#include <vector>
+
+#include <gsl/gsl>
+
+#include "Types.h"
+
+namespace ATK
+{
+  template<typename DataType_>
+  class Component;
+
+  /// Direct access to a parameter of a component, resolved once by the modeller
+  template<typename DataType_>
+  struct ParameterHandle
+  {
+    /// Component holding the parameter
+    Component<DataType_>* component = nullptr;
+    /// Index of the parameter in the component
+    gsl::index index = 0;
+
+    bool operator==(const ParameterHandle& other) const
+    {
+      return component == other.component && index == other.index;
+    }
+  };
+
+  /// A parameter change sent to the processing thread
+  template<typename DataType_>
+  struct ParameterChange
+  {
+    ParameterHandle<DataType_> handle;
+    /// New value of the parameter
+    DataType_ value = 0;
+    /// How the parameter goes from its current value to the new one
+    ParameterSmoothing smoothing = ParameterSmoothing::None;
+    /// Length of the smoothing in samples
+    gsl::index samples = 0;
+  };
+
+  /**
+   * Fixed size single producer, single consumer queue of parameter changes
+   * Pushing and popping don't allocate nor lock, the buffer is allocated by the constructor
+   */
+  template<typename DataType_>
+  class ParameterQueue
+  {
+  public:
+    using DataType = DataType_;
+
+    /**
+     * Constructor
+     * @param capacity is the maximum number of changes waiting in the queue
+     */
+    explicit ParameterQueue(gsl::index capacity)
+    :changes(capacity + 1)
+    {
+    }
+
+    /// Returns the maximum number of changes waiting in the queue
+    gsl::index get_capacity() const
+    {
+      return changes.size() - 1;
+    }
+
+    /**
+     * Adds a change to the queue, to be called from the producer thread only
+     * @return false if the queue is full
+     */
+    bool push(const ParameterChange<DataType>& change)
+    {
+      auto current_tail = tail.load(std::memory_order_relaxed);
+      auto next_tail = (current_tail + 1) % gsl::index(changes.size());
+      if(next_tail == head.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      changes[current_tail] = change;
+      tail.store(next_tail, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Gets the oldest change of the queue, to be called from the consumer thread only
+     * @return false if the queue is empty
+     */
+    bool pop(ParameterChange<DataType>& change)
+    {
+      auto current_head = head.load(std::memory_order_relaxed);
+      if(current_head == tail.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      change = changes[current_head];
+      head.store((current_head + 1) % gsl::index(changes.size()), std::memory_order_release);
+      return true;
+    }
+
+  private:
+    std::vector<ParameterChange<DataType>> changes;
+    std::atomic<gsl::index> head{0};
+    std::atomic<gsl::index> tail{0};
+  };
+}
+
+#endif
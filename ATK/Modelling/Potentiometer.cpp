@@ -0,0 +1,182 @@
+/**
+ * \file Potentiometer.cpp
+ */
+
+#include "DynamicModellerFilter.h"
+#include "Potentiometer.h"
+
+#include <ATK/Core/Utilities.h>
+
+#include <algorithm>
+
+namespace
+{
+  /// Minimum resistance between the wiper and an end of the track, relative to the whole track, so that the conductances stay finite near the ends
+  constexpr double TRACK_END_RESISTANCE = 1e-4;
+}
+
+namespace ATK
+{
+  template<typename DataType_>
+  Potentiometer<DataType_>::Potentiometer(DataType_ R, DataType_ position)
+  :R(R), position(position)
+  {
+    update_conductances();
+  }
+
+  template<typename DataType_>
+  void Potentiometer<DataType_>::update_conductances()
+  {
+    G0 = 1 / (R * std::max<DataType>(position, TRACK_END_RESISTANCE));
+    G1 = 1 / (R * std::max<DataType>(1 - position, TRACK_END_RESISTANCE));
+  }
+
+  template<typename DataType_>
+  void Potentiometer<DataType_>::precompute(bool steady_state)
+  {
+    if(pins.size() > 3)
+    {
+      position = std::clamp<DataType>(modeller->retrieve_voltage(pins[3]), 0, 1);
+      update_conductances();
+    }
+  }
+
+  template<typename DataType_>
+  DataType_ Potentiometer<DataType_>::get_current(gsl::index pin_index, bool steady_state) const
+  {
+    auto V0 = modeller->retrieve_voltage(pins[0]);
+    auto V1 = modeller->retrieve_voltage(pins[1]);
+    auto V2 = modeller->retrieve_voltage(pins[2]);
+    switch(pin_index)
+    {
+      case 0:
+        return (V1 - V0) * G0;
+      case 1:
+        return (V0 - V1) * G0 + (V2 - V1) * G1;
+      case 2:
+        return (V1 - V2) * G1;
+      default:
+        return 0;
+    }
+  }
+
+  template<typename DataType_>
+  DataType_ Potentiometer<DataType_>::get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const
+  {
+    if(pin_index == 3)
+    {
+      // The conductances change with the control voltage, except when the wiper is near an end of the track
+      auto control = modeller->retrieve_voltage(pins[3]);
+      if(control <= 0 || control >= 1)
+      {
+        return 0;
+      }
+      auto V0 = modeller->retrieve_voltage(pins[0]);
+      auto V1 = modeller->retrieve_voltage(pins[1]);
+      auto V2 = modeller->retrieve_voltage(pins[2]);
+      auto current0 = control > TRACK_END_RESISTANCE ? -(V1 - V0) * R * G0 * G0 : 0;
+      auto current2 = 1 - control > TRACK_END_RESISTANCE ? (V1 - V2) * R * G1 * G1 : 0;
+      switch(pin_index_ref)
+      {
+        case 0:
+          return current0;
+        case 1:
+          return -current0 - current2;
+        case 2:
+          return current2;
+        default:
+          return 0;
+      }
+    }
+
+    switch(pin_index_ref)
+    {
+      case 0:
+        return pin_index == 0 ? -G0 : pin_index == 1 ? G0 : 0;
+      case 1:
+        return pin_index == 0 ? G0 : pin_index == 1 ? -G0 - G1 : G1;
+      case 2:
+        return pin_index == 1 ? G1 : pin_index == 2 ? -G1 : 0;
+      default:
+        return 0;
+    }
+  }
+
+  template<typename DataType_>
+  bool Potentiometer<DataType_>::has_constant_gradient() const
+  {
+    return pins.size() == 3;
+  }
+
+  template<typename DataType_>
+  DataType_ Potentiometer<DataType_>::get_resistance() const
+  {
+    return R;
+  }
+
+  template<typename DataType_>
+  DataType_ Potentiometer<DataType_>::get_position() const
+  {
+    return position;
+  }
+
+  template<typename DataType_>
+  gsl::index Potentiometer<DataType_>::get_number_parameters() const
+  {
+    return 2;
+  }
+
+  template<typename DataType_>
+  std::string Potentiometer<DataType_>::get_parameter_name(gsl::index identifier) const
+  {
+    switch(identifier)
+    {
+      case 0:
+        return "R";
+      case 1:
+        return "position";
+      default:
+        throw RuntimeError("No such parameter");
+    }
+  }
+
+  template<typename DataType_>
+  DataType_ Potentiometer<DataType_>::get_parameter(gsl::index identifier) const
+  {
+    switch(identifier)
+    {
+      case 0:
+        return R;
+      case 1:
+        return position;
+      default:
+        throw RuntimeError("No such parameter");
+    }
+  }
+
+  template<typename DataType_>
+  void Potentiometer<DataType_>::set_parameter(gsl::index identifier, DataType_ value)
+  {
+    switch(identifier)
+    {
+      case 0:
+        R = value;
+        break;
+      case 1:
+        position = std::clamp<DataType>(value, 0, 1);
+        break;
+      default:
+        throw RuntimeError("No such parameter");
+    }
+    update_conductances();
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Potentiometer<DataType_>::clone() const
+  {
+    return std::make_unique<Potentiometer<DataType_>>(*this);
+  }
+
+  template class Potentiometer<float>;
+  template class Potentiometer<double>;
+}
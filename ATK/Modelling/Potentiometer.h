@@ -0,0 +1,87 @@
+/**
+ * \file Potentiometer.h
+ */
+
+#ifndef ATK_MODELLING_POTENTIOMETER_H
+#define ATK_MODELLING_POTENTIOMETER_H
+
+#include "Component.h"
+
+namespace ATK
+{
+  /**
+   * Potentiometer component
+   * The pins are the first end of the track, the wiper and the second end of the track
+   * An optional fourth pin controls the position of the wiper with its voltage, clamped between 0 (first end) and 1 (second end), usually an input pin
+   */
+  template<typename DataType_>
+  class ATK_MODELLING_EXPORT Potentiometer final: public Component<DataType_>
+  {
+  public:
+    using Parent = Component<DataType_>;
+    using DataType = DataType_;
+
+    /**
+     * Constructor
+     * @param R is the resistance of the whole track
+     * @param position is the position of the wiper when it is not controlled by a pin
+     */
+    Potentiometer(DataType R, DataType position = 0.5);
+
+    /**
+     * Get current for the given pin based on the state
+     * @param pin_index is the pin from which to compute the current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType_ get_current(gsl::index pin_index, bool steady_state) const override;
+
+    /**
+     * Get current gradient for the given pins based on the state
+     * @param pin_index_ref is the pin of the current from which the gradient is computed
+     * @param pin_index is the pin from which to compute the gradient of the pin_index current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType_ get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /**
+     * Reads the position of the wiper from the control pin
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void precompute(bool steady_state) override;
+
+    /// The gradient only depends on the parameters when the wiper is not controlled by a pin
+    bool has_constant_gradient() const override;
+
+    /// Returns the resistance of the whole track
+    DataType_ get_resistance() const;
+    /// Returns the current position of the wiper
+    DataType_ get_position() const;
+
+    /// The resistance of the track and the position of the wiper are the parameters
+    gsl::index get_number_parameters() const override;
+    /// Returns "R" or "position"
+    std::string get_parameter_name(gsl::index identifier) const override;
+    /// Returns the resistance or the position
+    DataType_ get_parameter(gsl::index identifier) const override;
+    /// Changes the resistance or the position, the position of a controlled wiper is overwritten by the next sample
+    void set_parameter(gsl::index identifier, DataType_ value) override;
+
+  private:
+    /// Computes the conductances of both parts of the track
+    void update_conductances();
+
+    DataType R;
+    DataType position;
+    /// Conductance between the first end and the wiper, and between the wiper and the second end
+    DataType G0;
+    DataType G1;
+  protected:
+    using Parent::modeller;
+    using Parent::pins;
+  };
+}
+
+#endif
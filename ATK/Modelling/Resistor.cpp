@@ -5,6 +5,8 @@
 #include "DynamicModellerFilter.h"
 #include "Resistor.h"
 
+#include <ATK/Core/Utilities.h>
+
 namespace ATK
 {
   template<typename DataType_>
@@ -24,6 +26,18 @@ namespace ATK
   {
     return inner.get_gradient() * (0 == pin_index_ref ? 1 : -1) * (1 == pin_index ? 1 : -1);
   }
+
+  template<typename DataType_>
+  void Resistor<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    Parent::stamp_dipole(eqs, jacobian_values, inner.get_current(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1])), inner.get_gradient());
+  }
+
+  template<typename DataType_>
+  bool Resistor<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
   
   template<typename DataType_>
   DataType_ Resistor<DataType_>::get_resistance() const
@@ -31,5 +45,48 @@ namespace ATK
     return inner.get_resistance();
   }
   
+  template<typename DataType_>
+  gsl::index Resistor<DataType_>::get_number_parameters() const
+  {
+    return 1;
+  }
+
+  template<typename DataType_>
+  std::string Resistor<DataType_>::get_parameter_name(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return "R";
+  }
+
+  template<typename DataType_>
+  DataType_ Resistor<DataType_>::get_parameter(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return inner.get_resistance();
+  }
+
+  template<typename DataType_>
+  void Resistor<DataType_>::set_parameter(gsl::index identifier, DataType_ value)
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    inner.set_resistance(value);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> Resistor<DataType_>::clone() const
+  {
+    return std::make_unique<Resistor<DataType_>>(*this);
+  }
+
+  template class Resistor<float>;
   template class Resistor<double>;
 }
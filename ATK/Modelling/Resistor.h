@@ -36,9 +36,32 @@ namespace ATK
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     DataType_ get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /**
+     * Adds the currents and gradients of this component to the equations and the jacobian
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const override;
+
+    /// The gradient of this component only depends on its value
+    bool has_constant_gradient() const override;
     
     /// Return the resistance value
     DataType_ get_resistance() const;
+
+    /// The resistance is the only parameter
+    gsl::index get_number_parameters() const override;
+    /// Returns "R"
+    std::string get_parameter_name(gsl::index identifier) const override;
+    /// Returns the resistance
+    DataType_ get_parameter(gsl::index identifier) const override;
+    /// Changes the resistance
+    void set_parameter(gsl::index identifier, DataType_ value) override;
   protected:
     using Parent::modeller;
     using Parent::pins;
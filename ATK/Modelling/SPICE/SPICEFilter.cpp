@@ -71,6 +71,8 @@ std::unique_ptr<ModellerFilter<DataType>> parseStrings(const std::vector<std::st
   return SPICEHandler<DataType>::convert(tree);
 }
 
+template ATK_MODELLING_EXPORT std::unique_ptr<ModellerFilter<float>> parse<float>(const std::string& filename);
+template ATK_MODELLING_EXPORT std::unique_ptr<ModellerFilter<float>> parseStrings<float>(const std::vector<std::string_view>& strings);
 template ATK_MODELLING_EXPORT std::unique_ptr<ModellerFilter<double>> parse<double>(const std::string& filename);
 template ATK_MODELLING_EXPORT std::unique_ptr<ModellerFilter<double>> parseStrings<double>(const std::vector<std::string_view>& strings);
 }
@@ -17,9 +17,12 @@
 #include <ATK/Modelling/Current.h>
 #include <ATK/Modelling/Diode.h>
 #include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/ExponentialControlledCurrent.h>
 #include <ATK/Modelling/ModellerFilter.h>
+#include <ATK/Modelling/Potentiometer.h>
 #include <ATK/Modelling/Resistor.h>
 #include <ATK/Modelling/Transistor.h>
+#include <ATK/Modelling/VoltageControlledCurrent.h>
 #include <ATK/Modelling/VoltageGain.h>
 #include <ATK/Modelling/SPICE/SPICEHandler.h>
 #include <ATK/Modelling/SPICE/parser.h>
@@ -191,6 +194,43 @@ namespace ATK
 #endif
   }
 
+  template<typename DataType>
+  void SPICEHandler<DataType>::add_potentiometer(const ast::Component& component)
+  {
+    if(component.second.size() != 4 && component.second.size() != 5)
+    {
+      throw RuntimeError("Wrong number of arguments for component " + component.first);
+    }
+    std::string pin0 = to_name(component.second[0]);
+    add_dynamic_pin(dynamic_pins, pin0);
+    std::string pin1 = to_name(component.second[1]);
+    add_dynamic_pin(dynamic_pins, pin1);
+    std::string pin2 = to_name(component.second[2]);
+    add_dynamic_pin(dynamic_pins, pin2);
+    double value = convert_component_value(boost::get<ast::SPICENumber>(component.second[3]));
+    std::vector<Pin> component_pins{pins[pin0], pins[pin1], pins[pin2]};
+    double position = 0.5;
+    if(component.second.size() == 5)
+    {
+      // A number is a fixed position, a name is the pin controlling the position
+      if(const auto* number = boost::get<ast::SPICENumber>(&component.second[4]))
+      {
+        position = convert_component_value(*number);
+      }
+      else
+      {
+        std::string control = to_name(component.second[4]);
+        add_dynamic_pin(dynamic_pins, control);
+        component_pins.push_back(pins[control]);
+      }
+    }
+    components.push_back(std::make_tuple(std::make_unique<Potentiometer<DataType>>(value, position), std::move(component_pins)));
+
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "Adding potentiometer: " << value << "\t" << pin0 << "\t" << pin1 << "\t" << pin2;
+#endif
+  }
+
   template<typename DataType>
   void SPICEHandler<DataType>::add_transistor(const ast::Component& component)
   {
@@ -250,6 +290,50 @@ namespace ATK
 #endif
   }
   
+  template<typename DataType>
+  void SPICEHandler<DataType>::add_voltage_controlled_current(const ast::Component& component)
+  {
+    if(component.second.size() < 5 || component.second.size() > 7)
+    {
+      throw RuntimeError("Wrong number of arguments for component " + component.first);
+    }
+    std::string pin0 = to_name(component.second[0]);
+    add_dynamic_pin(dynamic_pins, pin0);
+    std::string pin1 = to_name(component.second[1]);
+    add_dynamic_pin(dynamic_pins, pin1);
+    std::string pin2 = to_name(component.second[2]);
+    add_dynamic_pin(dynamic_pins, pin2);
+    std::string pin3 = to_name(component.second[3]);
+    add_dynamic_pin(dynamic_pins, pin3);
+    std::vector<Pin> component_pins{pins[pin2], pins[pin3], pins[pin0], pins[pin1]};
+
+    if(component.second.size() == 5)
+    {
+      double value = convert_component_value(boost::get<ast::SPICENumber>(component.second[4]));
+      components.push_back(std::make_tuple(std::make_unique<VoltageControlledCurrent<DataType>>(value), std::move(component_pins)));
+#if ENABLE_LOG
+      BOOST_LOG_TRIVIAL(trace) << "Adding voltage controlled current: " << value << "\t" << pin2 << "\t" << pin3 << "\t" << pin0 << "\t" << pin1;
+#endif
+      return;
+    }
+
+    // Exponential law, the arguments are EXP, the current for a null control voltage and optionally the thermal voltage
+    if(to_name(component.second[4]) != "exp")
+    {
+      throw RuntimeError("Unknown law for component " + component.first);
+    }
+    double value = convert_component_value(boost::get<ast::SPICENumber>(component.second[5]));
+    double vt = 26e-3;
+    if(component.second.size() == 7)
+    {
+      vt = convert_component_value(boost::get<ast::SPICENumber>(component.second[6]));
+    }
+    components.push_back(std::make_tuple(std::make_unique<ExponentialControlledCurrent<DataType>>(value, vt), std::move(component_pins)));
+#if ENABLE_LOG
+    BOOST_LOG_TRIVIAL(trace) << "Adding exponential controlled current: " << value << "\t" << vt << "\t" << pin2 << "\t" << pin3 << "\t" << pin0 << "\t" << pin1;
+#endif
+  }
+  
   template<typename DataType>
   void SPICEHandler<DataType>::generate_components()
   {
@@ -275,6 +359,11 @@ namespace ATK
           add_voltage_multiplier(component);
           break;
         }
+        case 'g':
+        {
+          add_voltage_controlled_current(component);
+          break;
+        }
         case 'i':
         {
           add_current(component);
@@ -285,6 +374,11 @@ namespace ATK
           add_coil(component);
           break;
         }
+        case 'p':
+        {
+          add_potentiometer(component);
+          break;
+        }
         case 'q':
         {
           add_transistor(component);
@@ -332,5 +426,6 @@ namespace ATK
     return components;
   }
 
+  template class SPICEHandler<float>;
   template class SPICEHandler<double>;
 }
@@ -59,6 +59,8 @@ class ATK_MODELLING_EXPORT SPICEHandler
   void add_diode(const ast::Component& component);
   /// Adds a resistance to the model
   void add_resistance(const ast::Component& component);
+  /// Adds a potentiometer to the model, the wiper position is a number or a control pin
+  void add_potentiometer(const ast::Component& component);
   /// Adds a transistor to the model
   void add_transistor(const ast::Component& component);
 
@@ -66,6 +68,8 @@ class ATK_MODELLING_EXPORT SPICEHandler
   void add_current(const ast::Component& component);
   /// Adds a voltage multiplier to the model
   void add_voltage_multiplier(const ast::Component& component);
+  /// Adds a voltage controlled current generator to the model, linear or exponential
+  void add_voltage_controlled_current(const ast::Component& component);
 
 public:
   /**
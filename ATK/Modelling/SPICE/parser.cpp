@@ -65,12 +65,14 @@ const auto component_name = x3::rule<class name, std::string>()
   = x3::char_(
               "cC"
               "lL"
+              "pP"
               "rR"
               "vV"
               "dD"
               "qQ"
               "iI"
               "eE"
+              "gG"
               )[tolower] >> *valid_char;
 
 const auto component_value = x3::rule<class component_value, ast::SPICENumber>()
@@ -0,0 +1,158 @@
+/**
+ * \file SolverStatistics.h
+ */
+
+#ifndef ATK_MODELLING_SOLVERSTATISTICS_H
+#define ATK_MODELLING_SOLVERSTATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include <gsl/gsl>
+
+namespace ATK
+{
+  /// Statistics of the Newton solver of the dynamic modeller for one processed block
+  template<typename DataType_>
+  struct SolverStatistics
+  {
+    using DataType = DataType_;
+
+    /// Number of bins of the iterations histogram
+    static constexpr gsl::index NB_ITERATION_BINS = 9;
+
+    /// Number of samples by number of iterations, bin 0 is for no iteration, bin i for [2^(i-1), 2^i) iterations, the last bin holds everything above
+    std::array<gsl::index, NB_ITERATION_BINS> iterations_histogram{};
+    /// Number of solved samples, oversampled ones included
+    gsl::index nb_samples = 0;
+    /// Total number of iterations
+    gsl::index nb_iterations = 0;
+    /// Number of samples that reached the maximum number of iterations without converging
+    gsl::index nb_not_converged = 0;
+    /// Number of samples that stopped before converging because of the real time budget
+    gsl::index nb_degraded = 0;
+    /// Number of samples that were split in sub steps
+    gsl::index nb_substepped = 0;
+    /// Number of iterations that used a limited junction voltage
+    gsl::index nb_limited_iterations = 0;
+    /// Number of factorizations of the jacobian
+    gsl::index nb_factorizations = 0;
+    /// Biggest absolute residual of the equations at the state kept for a sample
+    DataType max_residual = 0;
+    /// Processing time of the block divided by its number of input samples, the cost of the slowest sample is not available
+    double nanoseconds_per_sample = 0;
+
+    /// Returns the histogram bin for a number of iterations
+    static gsl::index get_bin(gsl::index iterations)
+    {
+      gsl::index bin = 0;
+      while(iterations > 0 && bin < NB_ITERATION_BINS - 1)
+      {
+        iterations >>= 1;
+        ++bin;
+      }
+      return bin;
+    }
+
+    /**
+     * Adds a sample to the statistics
+     * @param iterations is the number of iterations of the sample
+     * @param converged indicates if the iterations converged
+     * @param degraded indicates if the iterations were stopped by the real time budget
+     * @param residual is the final residual of the sample
+     */
+    void add_sample(gsl::index iterations, bool converged, bool degraded, DataType residual)
+    {
+      ++iterations_histogram[get_bin(iterations)];
+      ++nb_samples;
+      nb_iterations += iterations;
+      nb_not_converged += converged ? 0 : 1;
+      nb_degraded += degraded ? 1 : 0;
+      max_residual = std::max(max_residual, residual);
+    }
+  };
+
+  /**
+   * Statistics shared between the processing thread and readers
+   * A single writer publishes them without locking, readers retry until they get a consistent copy (sequence lock)
+   */
+  template<typename DataType_>
+  class SharedSolverStatistics
+  {
+  public:
+    using DataType = DataType_;
+
+    /// Publishes new statistics, to be called from the processing thread only
+    void store(const SolverStatistics<DataType>& statistics)
+    {
+      auto current_version = version.load(std::memory_order_relaxed);
+      version.store(current_version + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for(gsl::index i = 0; i < SolverStatistics<DataType>::NB_ITERATION_BINS; ++i)
+      {
+        iterations_histogram[i].store(statistics.iterations_histogram[i], std::memory_order_relaxed);
+      }
+      nb_samples.store(statistics.nb_samples, std::memory_order_relaxed);
+      nb_iterations.store(statistics.nb_iterations, std::memory_order_relaxed);
+      nb_not_converged.store(statistics.nb_not_converged, std::memory_order_relaxed);
+      nb_degraded.store(statistics.nb_degraded, std::memory_order_relaxed);
+      nb_substepped.store(statistics.nb_substepped, std::memory_order_relaxed);
+      nb_limited_iterations.store(statistics.nb_limited_iterations, std::memory_order_relaxed);
+      nb_factorizations.store(statistics.nb_factorizations, std::memory_order_relaxed);
+      max_residual.store(statistics.max_residual, std::memory_order_relaxed);
+      nanoseconds_per_sample.store(statistics.nanoseconds_per_sample, std::memory_order_relaxed);
+
+      version.store(current_version + 2, std::memory_order_release);
+    }
+
+    /// Returns the last published statistics, can be called from any thread
+    SolverStatistics<DataType> load() const
+    {
+      SolverStatistics<DataType> statistics;
+      while(true)
+      {
+        auto first_version = version.load(std::memory_order_acquire);
+        if(first_version % 2 == 1)
+        {
+          continue;
+        }
+        for(gsl::index i = 0; i < SolverStatistics<DataType>::NB_ITERATION_BINS; ++i)
+        {
+          statistics.iterations_histogram[i] = iterations_histogram[i].load(std::memory_order_relaxed);
+        }
+        statistics.nb_samples = nb_samples.load(std::memory_order_relaxed);
+        statistics.nb_iterations = nb_iterations.load(std::memory_order_relaxed);
+        statistics.nb_not_converged = nb_not_converged.load(std::memory_order_relaxed);
+        statistics.nb_degraded = nb_degraded.load(std::memory_order_relaxed);
+        statistics.nb_substepped = nb_substepped.load(std::memory_order_relaxed);
+        statistics.nb_limited_iterations = nb_limited_iterations.load(std::memory_order_relaxed);
+        statistics.nb_factorizations = nb_factorizations.load(std::memory_order_relaxed);
+        statistics.max_residual = max_residual.load(std::memory_order_relaxed);
+        statistics.nanoseconds_per_sample = nanoseconds_per_sample.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(version.load(std::memory_order_relaxed) == first_version)
+        {
+          return statistics;
+        }
+      }
+    }
+
+  private:
+    std::atomic<unsigned int> version{0};
+    std::array<std::atomic<gsl::index>, SolverStatistics<DataType>::NB_ITERATION_BINS> iterations_histogram{};
+    std::atomic<gsl::index> nb_samples{0};
+    std::atomic<gsl::index> nb_iterations{0};
+    std::atomic<gsl::index> nb_not_converged{0};
+    std::atomic<gsl::index> nb_degraded{0};
+    std::atomic<gsl::index> nb_substepped{0};
+    std::atomic<gsl::index> nb_limited_iterations{0};
+    std::atomic<gsl::index> nb_factorizations{0};
+    std::atomic<DataType> max_residual{0};
+    std::atomic<double> nanoseconds_per_sample{0};
+  };
+}
+
+#endif
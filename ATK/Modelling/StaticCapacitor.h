@@ -5,6 +5,8 @@
 #ifndef ATK_MODELLING_STATICCAPACITOR_H
 #define ATK_MODELLING_STATICCAPACITOR_H
 
+#include "ValueDescription.h"
+
 namespace ATK
 {
   /// Capacitor component
@@ -29,6 +31,17 @@ namespace ATK
       iceq = c2t * (V1 - V0);
     }
     
+    /**
+     * Changes the time step, the voltage and the current of the last step are kept
+     * @param dt is the delta that will be used in following updates
+     */
+    void update_time_step(DataType dt, DataType V0, DataType V1)
+    {
+      DataType new_c2t = (2 * C) / dt;
+      iceq += (new_c2t - c2t) * (V1 - V0);
+      c2t = new_c2t;
+    }
+
     /**
      * Update the component for its current state condition
      */
@@ -59,6 +72,24 @@ namespace ATK
       return C;
     }
     
+    /// Saves the equivalent current of the last step
+    void save_state(DataType* state) const
+    {
+      state[0] = iceq;
+    }
+
+    /// Restores the equivalent current saved by save_state
+    void restore_state(const DataType* state)
+    {
+      iceq = state[0];
+    }
+
+    /// Appends the capacitance to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, C);
+    }
+
   private:
     DataType C;
     DataType c2t = 0;
@@ -5,6 +5,8 @@
 #ifndef ATK_MODELLING_STATICCOIL_H
 #define ATK_MODELLING_STATICCOIL_H
 
+#include "ValueDescription.h"
+
 namespace ATK
 {
   /// Coil component
@@ -33,6 +35,20 @@ namespace ATK
       veq = l2t * i;
     }
     
+    /**
+     * Changes the time step, the voltage and the current of the last step are kept
+     * @param dt is the delta that will be used in following updates
+     */
+    void update_time_step(DataType dt, DataType V0, DataType V1)
+    {
+      DataType new_l2t = (2 * L) / dt;
+      // Current of the last step
+      DataType last_i = (veq - (V1 - V0)) * invl2t;
+      veq = new_l2t * last_i + (V1 - V0);
+      l2t = new_l2t;
+      invl2t = 1 / l2t;
+    }
+
     /**
      * Update the component for its current state condition
      */
@@ -82,6 +98,26 @@ namespace ATK
       return L;
     }
 
+    /// Saves the equivalent voltage and the current of the last step
+    void save_state(DataType* state) const
+    {
+      state[0] = veq;
+      state[1] = i;
+    }
+
+    /// Restores the equivalent voltage and the current saved by save_state
+    void restore_state(const DataType* state)
+    {
+      veq = state[0];
+      i = state[1];
+    }
+
+    /// Appends the inductance to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, L);
+    }
+
   private:
     DataType L;
     DataType l2t = 0;
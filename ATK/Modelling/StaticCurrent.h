@@ -5,6 +5,8 @@
 #ifndef ATK_MODELLING_STATICCURRENT_H
 #define ATK_MODELLING_STATICCURRENT_H
 
+#include "ValueDescription.h"
+
 namespace ATK
 {
   /// Current generator component
@@ -34,6 +36,13 @@ namespace ATK
     {
       return 0;
     }
+
+    /// Appends the current to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, C);
+    }
+
   private:
     DataType C;
   };
@@ -7,6 +7,9 @@
 
 #include <ATK/Utility/fmath.h>
 
+#include "StaticJunction.h"
+#include "ValueDescription.h"
+
 namespace ATK
 {
   /// Diode component
@@ -17,7 +20,7 @@ namespace ATK
     using DataType = DataType_;
 
     StaticDiode(DataType Is=1e-14, DataType N=1.24, DataType Vt = 26e-3)
-    :Is(Is), N(N), Vt(Vt), precomp(0)
+    :Is(Is), N(N), Vt(Vt), precomp(0), x_crit(junction_critical_voltage(Is, N * Vt))
     {
     }
     
@@ -26,7 +29,13 @@ namespace ATK
      */
     DataType get_current() const
     {
-      return Is * (direct * (precomp - 1) - indirect * (1 / precomp - 1));
+      DataType current = Is * (direct * (precomp - 1) - indirect * (1 / precomp - 1));
+      if(limiting)
+      {
+        // Linearization of the current around the limited voltage
+        current += get_gradient() * limited_voltage;
+      }
+      return current;
     }
     
     /**
@@ -42,7 +51,83 @@ namespace ATK
      */
     void precompute(DataType V0, DataType V1)
     {
-      precomp = fmath::exp((V1 - V0) / (N * Vt));
+      set_exponential(fmath::exp(get_exponent(V0, V1)));
+    }
+    
+    /**
+     * Returns the argument of the exponential used by precompute, limited if junction limiting is enabled
+     */
+    DataType get_exponent(DataType V0, DataType V1)
+    {
+      DataType x = (V1 - V0) / (N * Vt);
+      if(!limiting)
+      {
+        return x;
+      }
+      DataType x_limited = x;
+      if(direct)
+      {
+        x_limited = limit_junction_voltage(x_limited, x_old, x_crit);
+      }
+      if(indirect)
+      {
+        x_limited = -limit_junction_voltage(-x_limited, -x_old, x_crit);
+      }
+      x_old = x_limited;
+      limited_voltage = (x - x_limited) * (N * Vt);
+      return x_limited;
+    }
+    
+    /**
+     * Starts the limitation of the next iterations from the given voltages, which are not limited
+     */
+    void reset_limiting(DataType V0, DataType V1)
+    {
+      x_old = (V1 - V0) / (N * Vt);
+      limited_voltage = 0;
+    }
+
+    /// Returns true if the junction voltage was limited during the last precomputation
+    bool is_limited() const
+    {
+      return limited_voltage != 0;
+    }
+    
+    /**
+     * Enables the limitation of the junction voltage variation between two Newton iterations
+     */
+    void set_limiting(bool limiting)
+    {
+      this->limiting = limiting;
+      limited_voltage = 0;
+    }
+    
+    /**
+     * Sets the exponential of the argument returned by get_exponent
+     */
+    void set_exponential(DataType value)
+    {
+      precomp = value;
+    }
+
+    /// Saves the exponential and the junction voltage of the last iteration
+    void save_state(DataType* state) const
+    {
+      state[0] = precomp;
+      state[1] = x_old;
+    }
+
+    /// Restores the exponential and the junction voltage saved by save_state
+    void restore_state(const DataType* state)
+    {
+      precomp = state[0];
+      x_old = state[1];
+    }
+
+    /// Appends the model values to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, Is, N, Vt);
     }
 
   private:
@@ -50,6 +135,13 @@ namespace ATK
     DataType N;
     DataType Vt;
     DataType precomp;
+    
+    bool limiting = false;
+    DataType x_crit;
+    /// Junction voltage of the previous iteration
+    DataType x_old = 0;
+    /// Difference between the actual and the limited voltage
+    DataType limited_voltage = 0;
   };
 }
 
@@ -0,0 +1,46 @@
+/**
+ * \file StaticJunction.h
+ */
+
+#ifndef ATK_MODELLING_STATICJUNCTION_H
+#define ATK_MODELLING_STATICJUNCTION_H
+
+#include <cmath>
+
+namespace ATK
+{
+  /**
+   * Critical voltage of a junction, divided by the thermal voltage
+   * @param Is is the saturation current
+   * @param Vt is the thermal voltage (including the emission coefficient)
+   */
+  template<typename DataType>
+  DataType junction_critical_voltage(DataType Is, DataType Vt)
+  {
+    return std::log(Vt / (std::sqrt(static_cast<DataType>(2)) * Is));
+  }
+
+  /**
+   * Limits the variation of a junction voltage between two Newton iterations (SPICE pnjlim)
+   * Voltages are divided by the thermal voltage
+   * @param x is the new junction voltage
+   * @param x_old is the junction voltage used during the previous iteration
+   * @param x_crit is the critical voltage of the junction
+   */
+  template<typename DataType>
+  DataType limit_junction_voltage(DataType x, DataType x_old, DataType x_crit)
+  {
+    if(x > x_crit && std::abs(x - x_old) > 2)
+    {
+      if(x_old > 0)
+      {
+        DataType arg = 1 + (x - x_old);
+        return arg > 0 ? x_old + std::log(arg) : x_crit;
+      }
+      return std::log(x);
+    }
+    return x;
+  }
+}
+
+#endif
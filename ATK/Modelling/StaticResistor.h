@@ -43,6 +43,12 @@ namespace ATK
     {
       return 1/G;
     }
+
+    /// Changes the resistance value
+    void set_resistance(DataType R)
+    {
+      G = 1/R;
+    }
   private:
     DataType G;
   };
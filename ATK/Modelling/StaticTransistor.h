@@ -7,6 +7,9 @@
 
 #include <ATK/Utility/fmath.h>
 
+#include "StaticJunction.h"
+#include "ValueDescription.h"
+
 namespace ATK
 {
   /// Transistor NPN component
@@ -17,7 +20,7 @@ namespace ATK
     using DataType = DataType_;
 
     StaticNPN(DataType Is=1e-12, DataType Vt = 26e-3, DataType Ne = 1, DataType Br = 1, DataType Bf = 100)
-    :Is(Is), Vt(Vt*Ne), Br(Br), Bf(Bf), expVbe(0), expVbc(0)
+    :Is(Is), Vt(Vt*Ne), Br(Br), Bf(Bf), expVbe(0), expVbc(0), x_crit(junction_critical_voltage(Is, Vt*Ne))
     {
     }
     
@@ -26,8 +29,32 @@ namespace ATK
      */
     void precompute(DataType V0, DataType V1, DataType V2) const
     {
-      expVbe = fmath::exp((V0 - V2) / Vt);
-      expVbc = fmath::exp((V0 - V1) / Vt);
+      DataType exponents[2];
+      get_exponents(V0, V1, V2, exponents);
+      expVbe = fmath::exp(exponents[0]);
+      expVbc = fmath::exp(exponents[1]);
+    }
+    
+    /**
+     * Computes the arguments of the two exponentials used by precompute (Vbe then Vbc)
+     */
+    void get_exponents(DataType V0, DataType V1, DataType V2, DataType* exponents) const
+    {
+      exponents[0] = (V0 - V2) / Vt;
+      exponents[1] = (V0 - V1) / Vt;
+      if(limiting)
+      {
+        limit(exponents, 1);
+      }
+    }
+    
+    /**
+     * Sets the exponentials of the arguments computed by get_exponents
+     */
+    void set_exponentials(const DataType* values) const
+    {
+      expVbe = values[0];
+      expVbc = values[1];
     }
 
   private:
@@ -38,14 +65,97 @@ namespace ATK
     mutable DataType expVbe;
     mutable DataType expVbc;
 
+    bool limiting = false;
+    const DataType x_crit;
+    /// Junction voltages of the previous iteration
+    mutable DataType x_old[2] = {0, 0};
+    /// Differences between the actual and the limited Vbe and Vbc
+    mutable DataType limited_voltages[2] = {0, 0};
+    
+    /**
+     * Limits the two junction voltages
+     * @param exponents are the arguments of the exponentials to limit
+     * @param sign is the sign between the arguments and the junction voltages
+     */
+    void limit(DataType* exponents, DataType sign) const
+    {
+      for(int i = 0; i < 2; ++i)
+      {
+        DataType x_limited = limit_junction_voltage(exponents[i], x_old[i], x_crit);
+        limited_voltages[i] = sign * (exponents[i] - x_limited) * Vt;
+        x_old[i] = x_limited;
+        exponents[i] = x_limited;
+      }
+    }
+
   public:
+    /**
+     * Starts the limitation of the next iterations from the given voltages, which are not limited
+     */
+    void reset_limiting(DataType V0, DataType V1, DataType V2) const
+    {
+      x_old[0] = (V0 - V2) / Vt;
+      x_old[1] = (V0 - V1) / Vt;
+      limited_voltages[0] = limited_voltages[1] = 0;
+    }
+
+    /// Returns true if one of the junction voltages was limited during the last precomputation
+    bool is_limited() const
+    {
+      return limited_voltages[0] != 0 || limited_voltages[1] != 0;
+    }
+    
+    /**
+     * Enables the limitation of the junction voltages variation between two Newton iterations
+     */
+    void set_limiting(bool limiting)
+    {
+      this->limiting = limiting;
+      limited_voltages[0] = limited_voltages[1] = 0;
+    }
+    
+    /// Saves the exponentials and the junction voltages of the last iteration
+    void save_state(DataType* state) const
+    {
+      state[0] = expVbe;
+      state[1] = expVbc;
+      state[2] = x_old[0];
+      state[3] = x_old[1];
+    }
+
+    /// Restores the exponentials and the junction voltages saved by save_state
+    void restore_state(const DataType* state)
+    {
+      expVbe = state[0];
+      expVbc = state[1];
+      x_old[0] = state[2];
+      x_old[1] = state[3];
+    }
+
+    /// Appends the model values to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, Is, Vt, Br, Bf);
+    }
+
     DataType ib() const
     {
-      return Is * ((expVbe - 1) / Bf + (expVbc - 1) / Br);
+      DataType current = Is * ((expVbe - 1) / Bf + (expVbc - 1) / Br);
+      if(limiting)
+      {
+        // Linearization of the current around the limited voltages
+        current += ib_Vbe() * limited_voltages[0] + ib_Vbc() * limited_voltages[1];
+      }
+      return current;
     }
     DataType ic() const
     {
-      return Is * ((expVbe - expVbc) - (expVbc - 1) / Br);
+      DataType current = Is * ((expVbe - expVbc) - (expVbc - 1) / Br);
+      if(limiting)
+      {
+        current += ic_Vbe() * limited_voltages[0] + ic_Vbc() * limited_voltages[1];
+      }
+      return current;
     }
     DataType ib_Vbc() const
     {
@@ -73,7 +183,7 @@ namespace ATK
     using DataType = DataType_;
     
     StaticPNP(DataType Is=1e-12, DataType Vt = 26e-3, DataType Ne = 1, DataType Br = 1, DataType Bf = 100)
-    :Is(Is), Vt(Vt*Ne), Br(Br), Bf(Bf), expVbe(0), expVbc(0)
+    :Is(Is), Vt(Vt*Ne), Br(Br), Bf(Bf), expVbe(0), expVbc(0), x_crit(junction_critical_voltage(Is, Vt*Ne))
     {
     }
 
@@ -82,8 +192,32 @@ namespace ATK
      */
     void precompute(DataType V0, DataType V1, DataType V2) const
     {
-      expVbe = fmath::exp(-(V0 - V2) / Vt);
-      expVbc = fmath::exp(-(V0 - V1) / Vt);
+      DataType exponents[2];
+      get_exponents(V0, V1, V2, exponents);
+      expVbe = fmath::exp(exponents[0]);
+      expVbc = fmath::exp(exponents[1]);
+    }
+    
+    /**
+     * Computes the arguments of the two exponentials used by precompute (Vbe then Vbc)
+     */
+    void get_exponents(DataType V0, DataType V1, DataType V2, DataType* exponents) const
+    {
+      exponents[0] = -(V0 - V2) / Vt;
+      exponents[1] = -(V0 - V1) / Vt;
+      if(limiting)
+      {
+        limit(exponents, -1);
+      }
+    }
+    
+    /**
+     * Sets the exponentials of the arguments computed by get_exponents
+     */
+    void set_exponentials(const DataType* values) const
+    {
+      expVbe = values[0];
+      expVbc = values[1];
     }
     
   private:
@@ -93,15 +227,98 @@ namespace ATK
     const DataType Bf;
     mutable DataType expVbe;
     mutable DataType expVbc;
+
+    bool limiting = false;
+    const DataType x_crit;
+    /// Junction voltages of the previous iteration
+    mutable DataType x_old[2] = {0, 0};
+    /// Differences between the actual and the limited Vbe and Vbc
+    mutable DataType limited_voltages[2] = {0, 0};
+    
+    /**
+     * Limits the two junction voltages
+     * @param exponents are the arguments of the exponentials to limit
+     * @param sign is the sign between the arguments and the junction voltages
+     */
+    void limit(DataType* exponents, DataType sign) const
+    {
+      for(int i = 0; i < 2; ++i)
+      {
+        DataType x_limited = limit_junction_voltage(exponents[i], x_old[i], x_crit);
+        limited_voltages[i] = sign * (exponents[i] - x_limited) * Vt;
+        x_old[i] = x_limited;
+        exponents[i] = x_limited;
+      }
+    }
     
   public:
+    /**
+     * Starts the limitation of the next iterations from the given voltages, which are not limited
+     */
+    void reset_limiting(DataType V0, DataType V1, DataType V2) const
+    {
+      x_old[0] = -(V0 - V2) / Vt;
+      x_old[1] = -(V0 - V1) / Vt;
+      limited_voltages[0] = limited_voltages[1] = 0;
+    }
+
+    /// Returns true if one of the junction voltages was limited during the last precomputation
+    bool is_limited() const
+    {
+      return limited_voltages[0] != 0 || limited_voltages[1] != 0;
+    }
+    
+    /**
+     * Enables the limitation of the junction voltages variation between two Newton iterations
+     */
+    void set_limiting(bool limiting)
+    {
+      this->limiting = limiting;
+      limited_voltages[0] = limited_voltages[1] = 0;
+    }
+    
+    /// Saves the exponentials and the junction voltages of the last iteration
+    void save_state(DataType* state) const
+    {
+      state[0] = expVbe;
+      state[1] = expVbc;
+      state[2] = x_old[0];
+      state[3] = x_old[1];
+    }
+
+    /// Restores the exponentials and the junction voltages saved by save_state
+    void restore_state(const DataType* state)
+    {
+      expVbe = state[0];
+      expVbc = state[1];
+      x_old[0] = state[2];
+      x_old[1] = state[3];
+    }
+
+    /// Appends the model values to a description
+    void append_values(std::string& description) const
+    {
+      append_bytes(description, Is, Vt, Br, Bf);
+    }
+
     DataType ib() const
     {
-      return -Is * ((expVbe - 1) / Bf + (expVbc - 1) / Br);
+      DataType current = -Is * ((expVbe - 1) / Bf + (expVbc - 1) / Br);
+      if(limiting)
+      {
+        // Linearization of the current around the limited voltages
+        current += ib_Vbe() * limited_voltages[0] + ib_Vbc() * limited_voltages[1];
+      }
+      return current;
     }
     DataType ic() const
     {
-      return -Is * ((expVbe - expVbc) - (expVbc - 1) / Br);
+      DataType current = -Is * ((expVbe - expVbc) - (expVbc - 1) / Br);
+      if(limiting)
+      {
+        current += ic_Vbe() * limited_voltages[0] + ic_Vbc() * limited_voltages[1];
+      }
+      return current;
     }
     DataType ib_Vbc() const
     {
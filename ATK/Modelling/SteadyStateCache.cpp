@@ -0,0 +1,147 @@
+/**
+ * \file SteadyStateCache.cpp
+ */
+
+#include "SteadyStateCache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include <ATK/Core/Utilities.h>
+
+namespace
+{
+  /// Identifies a steady state cache file
+  constexpr char MAGIC[8] = {'A', 'T', 'K', 'S', 'S', 'C', 'A', 'C'};
+  /// Version of the file format, to be increased when it changes
+  constexpr std::uint32_t VERSION = 1;
+
+  template<typename T>
+  void write_value(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  T read_value(std::istream& stream)
+  {
+    T value;
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if(!stream)
+    {
+      throw ATK::RuntimeError("Truncated steady state cache");
+    }
+    return value;
+  }
+}
+
+namespace ATK
+{
+  template<typename DataType_>
+  bool SteadyStateCache<DataType_>::find(std::size_t key, Entry& entry) const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if(it == entries.end())
+    {
+      return false;
+    }
+    entry = it->second;
+    return true;
+  }
+
+  template<typename DataType_>
+  void SteadyStateCache<DataType_>::insert(std::size_t key, Entry entry)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[key] = std::move(entry);
+  }
+
+  template<typename DataType_>
+  gsl::index SteadyStateCache<DataType_>::size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<gsl::index>(entries.size());
+  }
+
+  template<typename DataType_>
+  void SteadyStateCache<DataType_>::clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+  }
+
+  template<typename DataType_>
+  void SteadyStateCache<DataType_>::save(std::ostream& stream) const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stream.write(MAGIC, sizeof(MAGIC));
+    write_value<std::uint32_t>(stream, VERSION);
+    write_value<std::uint32_t>(stream, sizeof(DataType));
+    write_value<std::uint64_t>(stream, entries.size());
+    for(const auto& [key, entry]: entries)
+    {
+      write_value<std::uint64_t>(stream, key);
+      write_value<std::uint64_t>(stream, entry.description.size());
+      stream.write(entry.description.data(), entry.description.size());
+      write_value<std::uint64_t>(stream, entry.dynamic_state.size());
+      stream.write(reinterpret_cast<const char*>(entry.dynamic_state.data()), entry.dynamic_state.size() * sizeof(DataType));
+      write_value<std::uint64_t>(stream, entry.component_states.size());
+      stream.write(reinterpret_cast<const char*>(entry.component_states.data()), entry.component_states.size() * sizeof(DataType));
+    }
+    if(!stream)
+    {
+      throw RuntimeError("Could not write the steady state cache");
+    }
+  }
+
+  template<typename DataType_>
+  void SteadyStateCache<DataType_>::load(std::istream& stream)
+  {
+    char magic[sizeof(MAGIC)];
+    stream.read(magic, sizeof(magic));
+    if(!stream || !std::equal(magic, magic + sizeof(magic), MAGIC))
+    {
+      throw RuntimeError("Not a steady state cache");
+    }
+    if(read_value<std::uint32_t>(stream) != VERSION)
+    {
+      throw RuntimeError("Unsupported steady state cache version");
+    }
+    if(read_value<std::uint32_t>(stream) != sizeof(DataType))
+    {
+      throw RuntimeError("Steady state cache saved with another precision");
+    }
+
+    // The whole stream is read before the cache is changed
+    std::unordered_map<std::size_t, Entry> new_entries;
+    auto nb_entries = read_value<std::uint64_t>(stream);
+    for(std::uint64_t i = 0; i < nb_entries; ++i)
+    {
+      auto key = static_cast<std::size_t>(read_value<std::uint64_t>(stream));
+      Entry entry;
+      entry.description.resize(static_cast<std::size_t>(read_value<std::uint64_t>(stream)));
+      stream.read(&entry.description[0], entry.description.size());
+      entry.dynamic_state.resize(static_cast<gsl::index>(read_value<std::uint64_t>(stream)));
+      stream.read(reinterpret_cast<char*>(entry.dynamic_state.data()), entry.dynamic_state.size() * sizeof(DataType));
+      entry.component_states.resize(static_cast<std::size_t>(read_value<std::uint64_t>(stream)));
+      stream.read(reinterpret_cast<char*>(entry.component_states.data()), entry.component_states.size() * sizeof(DataType));
+      if(!stream)
+      {
+        throw RuntimeError("Truncated steady state cache");
+      }
+      new_entries[key] = std::move(entry);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto& [key, entry]: new_entries)
+    {
+      entries[key] = std::move(entry);
+    }
+  }
+
+  template class SteadyStateCache<float>;
+  template class SteadyStateCache<double>;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file SteadyStateCache.h
+ */
+
+#ifndef ATK_MODELLING_STEADYSTATECACHE_H
+#define ATK_MODELLING_STEADYSTATECACHE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gsl/gsl>
+
+#include <Eigen/Eigen>
+
+#include "config.h"
+
+namespace ATK
+{
+  /**
+   * Steady states of circuits, shared by the dynamic modellers so that a circuit that was already set up doesn't go through the steady state computation again
+   * The circuits are identified by a hash of their description, their components, pins, parameters, static voltages, sampling rate and junction limitation (see DynamicModellerFilter::get_steady_state_description())
+   * The description is stored with the steady state and compared on lookup, so that a circuit with the same hash doesn't get the state of another one
+   * The cache can be used from several threads, and saved to a file to be reused by another process.
+   * A saved cache is only valid for the build of the library that wrote it: the descriptions use the mangled names of the component types and the binary representation of their values, which depend on the compiler and on the library version
+   */
+  template<typename DataType_>
+  class ATK_MODELLING_EXPORT SteadyStateCache
+  {
+  public:
+    using DataType = DataType_;
+
+    /// Converged steady state of a circuit
+    struct Entry
+    {
+      /// Description of the circuit, see DynamicModellerFilter::get_steady_state_description()
+      std::string description;
+      /// Voltages of the dynamic pins
+      Eigen::Matrix<DataType, Eigen::Dynamic, 1> dynamic_state;
+      /// Internal states of the components, in the order of the components of the modeller
+      std::vector<DataType> component_states;
+    };
+
+    /**
+     * Looks for the steady state of a circuit
+     * @param key identifies the circuit
+     * @param entry receives a copy of the steady state when it is found
+     * @return true if the circuit is in the cache
+     */
+    bool find(std::size_t key, Entry& entry) const;
+
+    /**
+     * Adds the steady state of a circuit, replacing the previous one
+     * @param key identifies the circuit
+     * @param entry is the steady state
+     */
+    void insert(std::size_t key, Entry entry);
+
+    /// Returns the number of circuits in the cache
+    gsl::index size() const;
+    /// Removes all the steady states
+    void clear();
+
+    /**
+     * Writes all the steady states in a binary stream
+     * @param stream is the output stream, opened in binary mode
+     */
+    void save(std::ostream& stream) const;
+
+    /**
+     * Reads steady states written by save(), they are added to the ones already in the cache
+     * @param stream is the input stream, opened in binary mode
+     */
+    void load(std::istream& stream);
+
+  private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::size_t, Entry> entries;
+  };
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include "DynamicModellerFilter.h"
 #include "Transistor.h"
 
+#include <array>
+
 namespace ATK
 {
   template<typename DataType_, template<typename> class StaticModel>
@@ -45,12 +47,110 @@ namespace ATK
     return -(inner.ib_Vbe() + inner.ic_Vbe());
   }
   
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    auto ib = inner.ib();
+    auto ic = inner.ic();
+    const std::array<DataType, 3> currents{{-ib, -ic, ib + ic}};
+    for(gsl::index i = 0; i < 3; ++i)
+    {
+      if(current_slots[i] != -1)
+      {
+        eqs(current_slots[i]) += currents[i];
+      }
+    }
+    if(jacobian_values == nullptr)
+    {
+      return;
+    }
+    
+    auto ib_Vbc = inner.ib_Vbc();
+    auto ib_Vbe = inner.ib_Vbe();
+    auto ic_Vbc = inner.ic_Vbc();
+    auto ic_Vbe = inner.ic_Vbe();
+    // Same layout as get_gradient
+    const std::array<DataType, 9> gradients{{
+      -(ib_Vbc + ib_Vbe), ib_Vbc, ib_Vbe,
+      -(ic_Vbc + ic_Vbe), ic_Vbc, ic_Vbe,
+      ib_Vbe + ib_Vbc + ic_Vbe + ic_Vbc, -(ib_Vbc + ic_Vbc), -(ib_Vbe + ic_Vbe)}};
+    for(gsl::index i = 0; i < 9; ++i)
+    {
+      if(gradient_slots[i] != -1)
+      {
+        jacobian_values[gradient_slots[i]] += gradients[i];
+      }
+    }
+  }
+
   template<typename DataType_, template<typename> class StaticModel>
   void Transistor<DataType_, StaticModel>::precompute(bool steady_state)
   {
     inner.precompute(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]), modeller->retrieve_voltage(pins[2]));
   }
 
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::get_exponents(DataType* exponents)
+  {
+    inner.get_exponents(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]), modeller->retrieve_voltage(pins[2]), exponents);
+  }
+  
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::set_exponentials(const DataType* values)
+  {
+    inner.set_exponentials(values);
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::set_junction_limiting(bool limiting)
+  {
+    inner.set_limiting(limiting);
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  bool Transistor<DataType_, StaticModel>::is_limited() const
+  {
+    return inner.is_limited();
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::reset_junction_limiting()
+  {
+    inner.reset_limiting(modeller->retrieve_voltage(pins[0]), modeller->retrieve_voltage(pins[1]), modeller->retrieve_voltage(pins[2]));
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  gsl::index Transistor<DataType_, StaticModel>::get_state_size() const
+  {
+    return 4;
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::save_state(DataType* state) const
+  {
+    inner.save_state(state);
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::restore_state(const DataType* state)
+  {
+    inner.restore_state(state);
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  void Transistor<DataType_, StaticModel>::append_values(std::string& description) const
+  {
+    inner.append_values(description);
+  }
+
+  template<typename DataType_, template<typename> class StaticModel>
+  std::unique_ptr<Component<DataType_>> Transistor<DataType_, StaticModel>::clone() const
+  {
+    return std::make_unique<Transistor<DataType_, StaticModel>>(*this);
+  }
+
+  template class Transistor<float, StaticNPN>;
+  template class Transistor<float, StaticPNP>;
   template class Transistor<double, StaticNPN>;
   template class Transistor<double, StaticPNP>;
 }
@@ -35,16 +35,65 @@ namespace ATK
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     DataType get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// Returns the number of values saved by save_state()
+    gsl::index get_state_size() const override;
+    /// Saves the exponentials and the junction voltages of the last iteration
+    void save_state(DataType* state) const override;
+    /// Restores the exponentials and the junction voltages of the last iteration
+    void restore_state(const DataType* state) override;
+    /// Appends the model values to a description
+    void append_values(std::string& description) const override;
+
+    /**
+     * Adds the three currents and their gradients to the equations and the jacobian
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const override;
     
     /**
      * Precompute internal value before asking current and gradients
      * @param steady_state is a flag to indcate steady state computation (used for some components)
      */
     void precompute(bool steady_state) override;
+    
+    /// Number of exponentials computed by precompute
+    static constexpr gsl::index nb_exponentials = 2;
+    
+    /**
+     * Stores the arguments of the exponentials of precompute, so that they can be computed in a batch
+     * @param exponents is where the nb_exponentials arguments are stored
+     */
+    void get_exponents(DataType* exponents);
+    
+    /**
+     * Finishes the precomputation with the batched exponentials
+     * @param values are the exponentials of the arguments returned by get_exponents
+     */
+    void set_exponentials(const DataType* values);
+
+    /**
+     * Enables the limitation of the junction voltages variation between two Newton iterations
+     * @param limiting activates the limitation
+     */
+    void set_junction_limiting(bool limiting);
+    
+    /// Returns true if a junction voltage was limited during the last precomputation
+    bool is_limited() const;
+
+    /// Starts the limitation of the next iterations from the junction voltages of the current state
+    void reset_junction_limiting();
 
   protected:
     using Parent::modeller;
     using Parent::pins;
+    using Parent::current_slots;
+    using Parent::gradient_slots;
   };
   
   template<typename DataType>
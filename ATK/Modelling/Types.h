@@ -14,6 +14,46 @@ namespace ATK
     Dynamic,
     Input
   };
+
+  /// Linear solver used for the Newton updates of the dynamic modeller
+  enum class SolverType
+  {
+    /// Dense QR decomposition of the full jacobian
+    Dense,
+    /// Sparse LU decomposition, the pattern is analyzed once during setup, the factorizations and solves allocate during processing
+    Sparse
+  };
+
+  /// Globalization of the Newton iterations of the dynamic modeller
+  enum class NewtonStrategy
+  {
+    /// The update is scaled down so that no voltage changes by more than 0.1V
+    Clamped,
+    /// Backtracking line search on the residual norm, starting from the full Newton update
+    LineSearch
+  };
+
+  /// Initial guess of the Newton iterations of the dynamic modeller for a new sample
+  enum class PredictorType
+  {
+    /// Previous state
+    ZeroOrder,
+    /// Linear extrapolation of the last two states
+    Linear,
+    /// Quadratic extrapolation of the last three states
+    Quadratic
+  };
+
+  /// Transition of a parameter of the dynamic modeller to a new value
+  enum class ParameterSmoothing
+  {
+    /// The new value is used from the next sample
+    None,
+    /// Linear ramp to the new value
+    Linear,
+    /// First order low pass to the new value
+    Exponential
+  };
 }
 
 #endif
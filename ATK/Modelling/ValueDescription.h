@@ -0,0 +1,24 @@
+/**
+ * \file ValueDescription.h
+ */
+
+#ifndef ATK_MODELLING_VALUEDESCRIPTION_H
+#define ATK_MODELLING_VALUEDESCRIPTION_H
+
+#include <string>
+
+namespace ATK
+{
+  /**
+   * Appends the bytes of values to a description, used by the components to describe the values that define their behavior
+   * @param description is the description to extend
+   * @param values are trivially copyable values
+   */
+  template<typename... Values>
+  void append_bytes(std::string& description, const Values&... values)
+  {
+    (description.append(reinterpret_cast<const char*>(&values), sizeof(values)), ...);
+  }
+}
+
+#endif
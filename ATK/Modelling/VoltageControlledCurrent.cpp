@@ -0,0 +1,110 @@
+/**
+ * \file VoltageControlledCurrent.cpp
+ */
+
+#include "DynamicModellerFilter.h"
+#include "VoltageControlledCurrent.h"
+
+#include <ATK/Core/Utilities.h>
+
+namespace ATK
+{
+  template<typename DataType_>
+  VoltageControlledCurrent<DataType_>::VoltageControlledCurrent(DataType_ G)
+  :G(G)
+  {
+  }
+
+  template<typename DataType_>
+  DataType_ VoltageControlledCurrent<DataType_>::get_control_voltage() const
+  {
+    return modeller->retrieve_voltage(pins[0]) - modeller->retrieve_voltage(pins[1]);
+  }
+
+  template<typename DataType_>
+  DataType_ VoltageControlledCurrent<DataType_>::get_current(gsl::index pin_index, bool steady_state) const
+  {
+    switch(pin_index)
+    {
+      case 2:
+        return -G * get_control_voltage();
+      case 3:
+        return G * get_control_voltage();
+      default:
+        return 0;
+    }
+  }
+  
+  template<typename DataType_>
+  DataType_ VoltageControlledCurrent<DataType_>::get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const
+  {
+    if(pin_index_ref < 2 || pin_index > 1)
+    {
+      return 0;
+    }
+    return G * (2 == pin_index_ref ? -1 : 1) * (0 == pin_index ? 1 : -1);
+  }
+
+  template<typename DataType_>
+  void VoltageControlledCurrent<DataType_>::stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const
+  {
+    Parent::stamp_transconductance(eqs, jacobian_values, G * get_control_voltage(), G);
+  }
+
+  template<typename DataType_>
+  bool VoltageControlledCurrent<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
+  
+  template<typename DataType_>
+  DataType_ VoltageControlledCurrent<DataType_>::get_transconductance() const
+  {
+    return G;
+  }
+
+  template<typename DataType_>
+  gsl::index VoltageControlledCurrent<DataType_>::get_number_parameters() const
+  {
+    return 1;
+  }
+
+  template<typename DataType_>
+  std::string VoltageControlledCurrent<DataType_>::get_parameter_name(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return "G";
+  }
+
+  template<typename DataType_>
+  DataType_ VoltageControlledCurrent<DataType_>::get_parameter(gsl::index identifier) const
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    return G;
+  }
+
+  template<typename DataType_>
+  void VoltageControlledCurrent<DataType_>::set_parameter(gsl::index identifier, DataType_ value)
+  {
+    if(identifier != 0)
+    {
+      throw RuntimeError("No such parameter");
+    }
+    G = value;
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> VoltageControlledCurrent<DataType_>::clone() const
+  {
+    return std::make_unique<VoltageControlledCurrent<DataType_>>(*this);
+  }
+
+  template class VoltageControlledCurrent<float>;
+  template class VoltageControlledCurrent<double>;
+}
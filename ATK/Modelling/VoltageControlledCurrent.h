@@ -0,0 +1,82 @@
+/**
+ * \file VoltageControlledCurrent.h
+ */
+
+#ifndef ATK_MODELLING_VOLTAGECONTROLLEDCURRENT_H
+#define ATK_MODELLING_VOLTAGECONTROLLEDCURRENT_H
+
+#include "Component.h"
+
+namespace ATK
+{
+  /**
+   * Current generator controlled by a voltage, with a linear transconductance
+   * The first two pins are the control pins, usually input or static pins, the current flows from the third pin to the fourth one
+   */
+  template<typename DataType_>
+  class ATK_MODELLING_EXPORT VoltageControlledCurrent final: public Component<DataType_>
+  {
+  public:
+    using Parent = Component<DataType_>;
+    using DataType = DataType_;
+
+    /**
+     * Constructor
+     * @param G is the transconductance, the ratio between the current and the control voltage
+     */
+    VoltageControlledCurrent(DataType G);
+    
+    /**
+     * Get current for the given pin based on the state
+     * @param pin_index is the pin from which to compute the current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType get_current(gsl::index pin_index, bool steady_state) const override;
+    
+    /**
+     * Get current gradient for the given pins based on the state
+     * @param pin_index_ref is the pin of the current from which the gradient is computed
+     * @param pin_index is the pin from which to compute the gradient of the pin_index current
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    DataType get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override;
+
+    /**
+     * Adds the currents and gradients of this component to the equations and the jacobian
+     * @param eqs is the state vector to update
+     * @param jacobian_values are the jacobian values (dense or sparse) to update, can be nullptr
+     * @param steady_state is a flag to indcate steady state computation (used for some components)
+     */
+    void stamp(Eigen::Matrix<DataType, Eigen::Dynamic, 1>& eqs, DataType* jacobian_values, bool steady_state) const override;
+
+    /// Returns a copy of this component and of its state, to be added to another modeller
+    std::unique_ptr<Component<DataType_>> clone() const override;
+
+    /// The gradient of this component only depends on its transconductance
+    bool has_constant_gradient() const override;
+    
+    /// Returns the transconductance
+    DataType get_transconductance() const;
+
+    /// The transconductance is the only parameter
+    gsl::index get_number_parameters() const override;
+    /// Returns "G"
+    std::string get_parameter_name(gsl::index identifier) const override;
+    /// Returns the transconductance
+    DataType_ get_parameter(gsl::index identifier) const override;
+    /// Changes the transconductance
+    void set_parameter(gsl::index identifier, DataType_ value) override;
+
+  private:
+    /// Returns the control voltage
+    DataType get_control_voltage() const;
+
+    DataType G;
+    
+  protected:
+    using Parent::modeller;
+    using Parent::pins;
+  };
+}
+
+#endif
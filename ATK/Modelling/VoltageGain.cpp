@@ -3,6 +3,7 @@
  */
 
 #include "DynamicModellerFilter.h"
+#include "ValueDescription.h"
 #include "VoltageGain.h"
 
 namespace ATK
@@ -24,6 +25,12 @@ namespace ATK
   {
     return 0;
   }
+
+  template<typename DataType_>
+  bool VoltageGain<DataType_>::has_constant_gradient() const
+  {
+    return true;
+  }
   
   template<typename DataType_>
   void VoltageGain<DataType_>::update_model(DynamicModellerFilter<DataType>* modeller)
@@ -55,5 +62,18 @@ namespace ATK
     }
   }
 
+  template<typename DataType_>
+  void VoltageGain<DataType_>::append_values(std::string& description) const
+  {
+    append_bytes(description, G);
+  }
+
+  template<typename DataType_>
+  std::unique_ptr<Component<DataType_>> VoltageGain<DataType_>::clone() const
+  {
+    return std::make_unique<VoltageGain<DataType_>>(*this);
+  }
+
+  template class VoltageGain<float>;
   template class VoltageGain<double>;
 }
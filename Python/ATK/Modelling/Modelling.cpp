@@ -5,6 +5,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include <string>
+
 #include <ATK/Modelling/ModellerFilter.h>
 #include <ATK/Modelling/SPICE/SPICEHandler.h>
 #include <ATK/Modelling/SPICE/parser.h>
@@ -19,6 +21,7 @@ PYBIND11_MODULE(PythonModelling, m)
 {
   m.doc() = "Audio ToolKit Modelling module";
   
+  py::object f1 = (py::object) py::module::import("ATK.Core").attr("FloatTypedBaseFilter");
   py::object f2 = (py::object) py::module::import("ATK.Core").attr("DoubleTypedBaseFilter");
   
   py::class_<ATK::ast::SPICEAST>(m, "AST")
@@ -28,9 +31,35 @@ PYBIND11_MODULE(PythonModelling, m)
   })
   ;
   
+  py::class_<ATK::ModellerFilter<float>>(m, "FloatModellerFilter", f1)
+  .def_static("create_dynamic_filter", [](const ATK::ast::SPICEAST& tree) {
+    return ATK::SPICEHandler<float>::convert(tree);
+  })
+  .def("clone", &ATK::ModellerFilter<float>::clone)
+  .def("save_snapshot", [](const ATK::ModellerFilter<float>& filter) {
+    std::string snapshot(filter.get_snapshot_size(), '\0');
+    filter.save_snapshot(snapshot.data(), snapshot.size());
+    return py::bytes(snapshot);
+  })
+  .def("restore_snapshot", [](ATK::ModellerFilter<float>& filter, const py::bytes& snapshot) {
+    std::string buffer = snapshot;
+    filter.restore_snapshot(buffer.data(), buffer.size());
+  })
+  ;
+  
   py::class_<ATK::ModellerFilter<double>>(m, "DoubleModellerFilter", f2)
   .def_static("create_dynamic_filter", [](const ATK::ast::SPICEAST& tree) {
     return ATK::SPICEHandler<double>::convert(tree);
   })
+  .def("clone", &ATK::ModellerFilter<double>::clone)
+  .def("save_snapshot", [](const ATK::ModellerFilter<double>& filter) {
+    std::string snapshot(filter.get_snapshot_size(), '\0');
+    filter.save_snapshot(snapshot.data(), snapshot.size());
+    return py::bytes(snapshot);
+  })
+  .def("restore_snapshot", [](ATK::ModellerFilter<double>& filter, const py::bytes& snapshot) {
+    std::string buffer = snapshot;
+    filter.restore_snapshot(buffer.data(), buffer.size());
+  })
   ;
 }
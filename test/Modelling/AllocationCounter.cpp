@@ -0,0 +1,20 @@
+/**
+ * \ file AllocationCounter.cpp
+ */
+
+#include <cstdlib>
+
+#include "AllocationCounter.h"
+
+std::atomic<gsl::index> nb_allocations{0};
+
+#if ATK_MODELLING_TEST_COUNT_ALLOCATIONS
+// The operator new of the C++ library calls malloc as well
+extern "C" void* __libc_malloc(std::size_t size);
+
+extern "C" void* malloc(std::size_t size) noexcept
+{
+  ++nb_allocations;
+  return __libc_malloc(size);
+}
+#endif
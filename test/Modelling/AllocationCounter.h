@@ -0,0 +1,36 @@
+/**
+ * \ file AllocationCounter.h
+ * Counter of the allocations of the test program, used to check that processing doesn't allocate
+ */
+
+#ifndef ATK_MODELLING_TEST_ALLOCATIONCOUNTER_H
+#define ATK_MODELLING_TEST_ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstdlib>
+
+#include <gsl/gsl>
+
+#if defined(__has_feature)
+# if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#  define ATK_MODELLING_TEST_SANITIZER
+# endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+# define ATK_MODELLING_TEST_SANITIZER
+#endif
+
+/**
+ * Eigen allocates its matrices with malloc, so the allocations are counted by replacing malloc, which is only possible with the GNU C library
+ * The sanitizers replace malloc as well, and the counter is then disabled
+ */
+#if defined(__GLIBC__) && !defined(ATK_MODELLING_TEST_SANITIZER)
+# define ATK_MODELLING_TEST_COUNT_ALLOCATIONS 1
+#else
+# define ATK_MODELLING_TEST_COUNT_ALLOCATIONS 0
+#endif
+
+/// Number of allocations of the test program, stays at 0 when the allocations are not counted
+extern std::atomic<gsl::index> nb_allocations;
+
+#endif
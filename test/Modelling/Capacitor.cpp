@@ -53,3 +53,17 @@ BOOST_AUTO_TEST_CASE( Capacitor_RC )
     BOOST_CHECK_CLOSE(1 - std::exp(-(i+.5) * dt / (R * C)), model.get_output_array(0)[i], 1);
   }
 }
+
+BOOST_AUTO_TEST_CASE( Capacitor_time_step )
+{
+  ATK::StaticCapacitor<double> capacitor(C);
+  capacitor.update_steady_state(dt, 0, 1);
+  capacitor.update_state(0, 2);
+  auto current = capacitor.get_current(0, 3);
+
+  // Changing the time step back and forth keeps the state
+  capacitor.update_time_step(dt / 4, 0, 2);
+  BOOST_CHECK_CLOSE(capacitor.get_gradient(), 4 * 2 * C / dt, 1e-10);
+  capacitor.update_time_step(dt, 0, 2);
+  BOOST_CHECK_CLOSE(capacitor.get_current(0, 3), current, 1e-8);
+}
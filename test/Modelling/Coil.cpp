@@ -53,3 +53,25 @@ BOOST_AUTO_TEST_CASE( Coil_RC )
     BOOST_CHECK_CLOSE(1 - std::exp(-(i+.5) * dt * L / R), model.get_output_array(0)[i], 1);
   }
 }
+
+BOOST_AUTO_TEST_CASE( Coil_time_step )
+{
+  ATK::StaticCoil<double> coil(L);
+  coil.update_steady_state(dt);
+  coil.precompute(0, 1, false);
+  coil.update_state();
+  auto last_current = coil.get_current();
+  coil.precompute(0, 3, false);
+  auto current = coil.get_current();
+
+  // The current of the last step is kept, the next one is integrated with the new time step
+  coil.update_time_step(dt / 4, 0, 1);
+  BOOST_CHECK_CLOSE(coil.get_gradient(false), dt / 4 / (2 * L), 1e-10);
+  coil.precompute(0, 1, false);
+  BOOST_CHECK_CLOSE(coil.get_current(), last_current + dt / 4 / (2 * L) * (1 + 1), 1e-8);
+
+  // Changing the time step back and forth keeps the state
+  coil.update_time_step(dt, 0, 1);
+  coil.precompute(0, 3, false);
+  BOOST_CHECK_CLOSE(coil.get_current(), current, 1e-8);
+}
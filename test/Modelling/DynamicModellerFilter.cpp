@@ -0,0 +1,1354 @@
+/**
+ * \ file DynamicModellerFilter.cpp
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ATK/config.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/Capacitor.h>
+#include <ATK/Modelling/Coil.h>
+#include <ATK/Modelling/Diode.h>
+#include <ATK/Modelling/ExponentialControlledCurrent.h>
+#include <ATK/Modelling/LockstepModellerFilter.h>
+#include <ATK/Modelling/Resistor.h>
+#include <ATK/Modelling/StaticJunction.h>
+#include <ATK/Modelling/Transistor.h>
+#include <ATK/Modelling/VoltageControlledCurrent.h>
+#include <ATK/Modelling/VoltageGain.h>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include "AllocationCounter.h"
+#include "ModellerTestCircuits.h"
+
+namespace
+{
+  /**
+   * Antiparallel diodes driven by the input through a small resistor
+   * Without capacitor the diode voltage follows the input steps, and a few volts drive it above the critical voltage of the junctions
+   */
+  std::unique_ptr<ATK::DynamicModellerFilter<double>> create_resistive_clipper()
+  {
+    auto model = std::make_unique<ATK::DynamicModellerFilter<double>>(1, 1, 1);
+
+    model->add_component(std::make_unique<ATK::Diode<double, 1, 1>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model->add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+
+    return model;
+  }
+
+  /// A diode biased through a resistor, with a coil to the ground, so that the steady state is not trivial
+  std::unique_ptr<ATK::DynamicModellerFilter<double>> create_biased_circuit(double bias, std::shared_ptr<ATK::SteadyStateCache<double>> cache = nullptr, bool junction_limiting = false)
+  {
+    auto model = std::make_unique<ATK::DynamicModellerFilter<double>>(2, 2, 1);
+    model->set_steady_state_cache(cache);
+    model->set_junction_limiting(junction_limiting);
+    Eigen::Matrix<double, Eigen::Dynamic, 1> static_state(2);
+    static_state << 0, bias;
+    model->set_static_state(static_state);
+
+    model->add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Static, 1), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model->add_component(std::make_unique<ATK::Diode<double>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+    model->add_component(std::make_unique<ATK::Coil<double>>(1e-3), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+    model->add_component(std::make_unique<ATK::Resistor<double>>(2000), {{std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+    model->add_component(std::make_unique<ATK::Capacitor<double>>(100e-9), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model->set_input_sampling_rate(SAMPLING_RATE);
+    model->set_output_sampling_rate(SAMPLING_RATE);
+
+    return model;
+  }
+
+  /// A conductance that counts how many times its gradient is asked
+  class CountingConductance final: public ATK::Component<double>
+  {
+  public:
+    explicit CountingConductance(double G)
+    :G(G)
+    {
+    }
+
+    double get_current(gsl::index pin_index, bool steady_state) const override
+    {
+      return (modeller->retrieve_voltage(pins[1]) - modeller->retrieve_voltage(pins[0])) * G * (0 == pin_index ? 1 : -1);
+    }
+
+    double get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override
+    {
+      ++nb_gradients;
+      return G * (0 == pin_index_ref ? 1 : -1) * (1 == pin_index ? 1 : -1);
+    }
+
+    bool has_constant_gradient() const override
+    {
+      return true;
+    }
+
+    gsl::index get_nb_gradients() const
+    {
+      return nb_gradients;
+    }
+
+  private:
+    double G;
+    mutable gsl::index nb_gradients = 0;
+  };
+
+  /// A modeller written outside of the library, it only implements the mandatory methods
+  class MinimalModeller final: public ATK::ModellerFilter<double>
+  {
+  public:
+    MinimalModeller()
+    :ModellerFilter<double>(1, 0)
+    {
+    }
+
+    Eigen::Matrix<double, Eigen::Dynamic, 1> get_static_state() const override
+    {
+      return Eigen::Matrix<double, Eigen::Dynamic, 1>();
+    }
+
+    gsl::index get_nb_dynamic_pins() const override
+    {
+      return 1;
+    }
+
+    gsl::index get_nb_static_pins() const override
+    {
+      return 0;
+    }
+
+    gsl::index get_nb_input_pins() const override
+    {
+      return 0;
+    }
+
+    gsl::index get_nb_components() const override
+    {
+      return 0;
+    }
+
+    std::string get_dynamic_pin_name(gsl::index identifier) const override
+    {
+      return "out";
+    }
+
+    std::string get_static_pin_name(gsl::index identifier) const override
+    {
+      throw ATK::RuntimeError("No static pin");
+    }
+
+    gsl::index get_number_parameters() const override
+    {
+      return 0;
+    }
+
+    std::string get_parameter_name(gsl::index identifier) const override
+    {
+      throw ATK::RuntimeError("No such parameter");
+    }
+
+    double get_parameter(gsl::index identifier) const override
+    {
+      throw ATK::RuntimeError("No such parameter");
+    }
+
+    void set_parameter(gsl::index identifier, double value) override
+    {
+      throw ATK::RuntimeError("No such parameter");
+    }
+
+  protected:
+    void process_impl(gsl::index size) const override
+    {
+      std::fill(outputs[0], outputs[0] + size, 0);
+    }
+  };
+
+  /// A current source that can't be evaluated, the iterations never converge
+  class UndefinedCurrent final: public ATK::Component<double>
+  {
+  public:
+    double get_current(gsl::index pin_index, bool steady_state) const override
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double get_gradient(gsl::index pin_index_ref, gsl::index pin_index, bool steady_state) const override
+    {
+      return 0;
+    }
+  };
+
+}
+
+namespace
+{
+  /// Processes the first half of the signal, then checks that the second half is processed without any allocation
+  template<typename DataType>
+  void check_no_allocation(ATK::DynamicModellerFilter<DataType>& model, const std::array<double, PROCESSSIZE>& data)
+  {
+    std::array<DataType, PROCESSSIZE> input;
+    std::copy(data.begin(), data.end(), input.begin());
+    ATK::InPointerFilter<DataType> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+    model.set_input_sampling_rate(SAMPLING_RATE);
+    model.set_output_sampling_rate(SAMPLING_RATE);
+    model.set_input_port(0, &generator, 0);
+    model.process(PROCESSSIZE / 2);
+
+    gsl::index allocations = nb_allocations;
+    model.process(PROCESSSIZE / 2);
+    BOOST_CHECK_EQUAL(nb_allocations - allocations, 0);
+  }
+
+  /**
+   * Processes a sine of a different amplitude with each instance of a lockstep modeller and checks that they give the results of independent modellers
+   * The second half of the signals is processed without any allocation
+   * @param lockstep is the lockstep modeller, its instances can have different parameters
+   * @param tolerance is the biggest absolute difference allowed with the independent modellers
+   * @param change is applied to each instance and to its independent modeller after the first half of the signals
+   */
+  void check_lockstep(ATK::LockstepModellerFilter<double>& lockstep, double tolerance, std::function<void(ATK::DynamicModellerFilter<double>&, gsl::index)> change = nullptr)
+  {
+    gsl::index nb_lanes = lockstep.get_nb_lanes();
+    std::vector<std::array<double, PROCESSSIZE>> data;
+    std::vector<std::unique_ptr<ATK::InPointerFilter<double>>> generators;
+    std::vector<std::unique_ptr<ATK::DynamicModellerFilter<double>>> references;
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      data.push_back(create_sine(lane + 1));
+    }
+    lockstep.set_input_sampling_rate(SAMPLING_RATE);
+    lockstep.set_output_sampling_rate(SAMPLING_RATE);
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      // Each instance has its own generators, a generator is read once by process()
+      references.push_back(lockstep.get_lane(lane).clone_dynamic());
+      for(gsl::index i = 0; i < 2; ++i)
+      {
+        generators.push_back(std::make_unique<ATK::InPointerFilter<double>>(data[lane].data(), 1, PROCESSSIZE, false));
+        generators.back()->set_output_sampling_rate(SAMPLING_RATE);
+      }
+      references.back()->set_input_sampling_rate(SAMPLING_RATE);
+      references.back()->set_output_sampling_rate(SAMPLING_RATE);
+      references.back()->set_input_port(0, generators[2 * lane].get(), 0);
+      lockstep.set_input_port(lane, generators[2 * lane + 1].get(), 0);
+    }
+
+    gsl::index nb_outputs = references.front()->get_nb_output_ports();
+    for(gsl::index half = 0; half < 2; ++half)
+    {
+      if(half == 1 && change)
+      {
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          change(lockstep.get_lane(lane), lane);
+          change(*references[lane], lane);
+        }
+      }
+      gsl::index allocations = nb_allocations;
+      lockstep.process(PROCESSSIZE / 2);
+      if(half == 1)
+      {
+#if ATK_MODELLING_TEST_COUNT_ALLOCATIONS
+        BOOST_CHECK_EQUAL(nb_allocations - allocations, 0);
+#else
+        BOOST_TEST_MESSAGE("Allocations are not counted on this platform, skipping the allocation check of the lockstep modeller");
+#endif
+      }
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        references[lane]->process(PROCESSSIZE / 2);
+        for(gsl::index j = 0; j < nb_outputs; ++j)
+        {
+          for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+          {
+            BOOST_CHECK_SMALL(references[lane]->get_output_array(j)[i] - lockstep.get_output_array(lane * nb_outputs + j)[i], tolerance);
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_no_allocation, * boost::unit_test::enable_if<ATK_MODELLING_TEST_COUNT_ALLOCATIONS>() )
+{
+  auto data = create_sine(5);
+  check_no_allocation(*create_clipper(), data);
+
+  auto chord = create_clipper();
+  chord->set_chord_newton(true);
+  check_no_allocation(*chord, data);
+
+  auto line_search = create_clipper();
+  line_search->set_newton_strategy(ATK::NewtonStrategy::LineSearch);
+  line_search->set_junction_limiting(true);
+  line_search->set_predictor(ATK::PredictorType::Quadratic);
+  line_search->enable_statistics(true);
+  check_no_allocation(*line_search, create_sine(48));
+
+  auto budget = create_clipper();
+  budget->set_realtime_budget(3, 0, 2);
+  budget->enable_statistics(true);
+  check_no_allocation(*budget, create_sine(48));
+
+  // The step is in the second half, the sample that doesn't converge is split in sub steps
+  std::array<double, PROCESSSIZE> step;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    step[i] = i < 3 * PROCESSSIZE / 4 ? 0 : 1000;
+  }
+  auto substeps = create_clipper();
+  substeps->set_max_substeps(8);
+  substeps->enable_statistics(true);
+  check_no_allocation(*substeps, step);
+  BOOST_CHECK_GT(substeps->get_statistics().nb_substepped, 0);
+
+  auto oversampled = create_clipper();
+  oversampled->set_oversampling(4);
+  check_no_allocation(*oversampled, data);
+
+  auto mixed_precision = create_clipper<float>();
+  mixed_precision->set_mixed_precision(true);
+  check_no_allocation(*mixed_precision, data);
+
+  // A smoothed parameter change is applied with low rank updates of the factorization of the linear circuit
+  ATK::DynamicModellerFilter<double> linear(1, 1, 1);
+  linear.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  linear.add_component(std::make_unique<ATK::Coil<double>>(1e-3), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  BOOST_CHECK(linear.push_parameter(linear.get_parameter_handle(0), 5000, ATK::ParameterSmoothing::Linear, PROCESSSIZE));
+  check_no_allocation(linear, data);
+  BOOST_CHECK(linear.is_linear());
+}
+
+namespace
+{
+  /// Outputs and statistics of a modeller that processed a signal
+  struct SolverRun
+  {
+    std::vector<std::vector<double>> outputs;
+    ATK::SolverStatistics<double> statistics;
+  };
+
+  /// Processes a signal with a modeller, its statistics have to be enabled
+  template<typename DataType>
+  SolverRun run_solver(ATK::DynamicModellerFilter<DataType>& model, const std::array<double, PROCESSSIZE>& data)
+  {
+    std::array<DataType, PROCESSSIZE> input;
+    std::copy(data.begin(), data.end(), input.begin());
+    ATK::InPointerFilter<DataType> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+    process(model, generator);
+
+    SolverRun run;
+    for(gsl::index j = 0; j < model.get_nb_output_ports(); ++j)
+    {
+      run.outputs.emplace_back(model.get_output_array(j), model.get_output_array(j) + PROCESSSIZE);
+    }
+    auto statistics = model.get_statistics();
+    run.statistics.iterations_histogram = statistics.iterations_histogram;
+    run.statistics.nb_samples = statistics.nb_samples;
+    run.statistics.nb_iterations = statistics.nb_iterations;
+    run.statistics.nb_not_converged = statistics.nb_not_converged;
+    run.statistics.nb_degraded = statistics.nb_degraded;
+    run.statistics.nb_substepped = statistics.nb_substepped;
+    run.statistics.nb_limited_iterations = statistics.nb_limited_iterations;
+    run.statistics.nb_factorizations = statistics.nb_factorizations;
+    run.statistics.max_residual = statistics.max_residual;
+    run.statistics.nanoseconds_per_sample = statistics.nanoseconds_per_sample;
+    return run;
+  }
+
+  /// Returns a function processing a signal with the clipper configured by a function
+  template<typename DataType = double, typename Configure>
+  std::function<SolverRun(const std::array<double, PROCESSSIZE>&)> run_clipper(Configure configure)
+  {
+    return [configure](const std::array<double, PROCESSSIZE>& data)
+    {
+      auto model = create_clipper<DataType>();
+      model->enable_statistics(true);
+      configure(*model);
+      return run_solver(*model, data);
+    };
+  }
+
+  /// An option of the solver, compared with the default solver on the same signal
+  struct SolverOption
+  {
+    std::string name;
+    std::array<double, PROCESSSIZE> data;
+    /// Number of samples at the beginning of the signal where both solvers must agree
+    gsl::index compared_samples;
+    double tolerance;
+    /// Processes the signal with the default solver
+    std::function<SolverRun(const std::array<double, PROCESSSIZE>&)> run_reference;
+    /// Processes the signal with the option
+    std::function<SolverRun(const std::array<double, PROCESSSIZE>&)> run;
+    /// Checks what the option brings, from the statistics of both solvers
+    std::function<void(const SolverRun& reference, const SolverRun& run)> check;
+  };
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_solver_options )
+{
+  auto default_clipper = run_clipper([](ATK::DynamicModellerFilter<double>&){});
+  // A big step can't converge in one sample with the clamped Newton updates
+  std::array<double, PROCESSSIZE> step;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    step[i] = i < PROCESSSIZE / 2 ? 0 : 1000;
+  }
+  // The same load, as a resistor and as a conductance counting its gradients
+  const CountingConductance* counting = nullptr;
+
+  std::vector<SolverOption> options;
+  options.push_back({"sparse", create_sine(5), PROCESSSIZE, 1e-6, default_clipper,
+    run_clipper([](ATK::DynamicModellerFilter<double>& model)
+    {
+      model.set_solver_type(ATK::SolverType::Sparse);
+      BOOST_CHECK(model.get_solver_type() == ATK::SolverType::Sparse);
+    }),
+    [](const SolverRun& reference, const SolverRun& run)
+    {
+      // Both solvers follow the same Newton iterations, the sparse one factorizes the jacobian at each of them
+      BOOST_CHECK_EQUAL(run.statistics.nb_iterations, reference.statistics.nb_iterations);
+      BOOST_CHECK_EQUAL(run.statistics.nb_factorizations, run.statistics.nb_iterations);
+    }});
+  options.push_back({"chord", create_sine(5), PROCESSSIZE, 1e-4, default_clipper,
+    run_clipper([](ATK::DynamicModellerFilter<double>& model)
+    {
+      model.set_chord_newton(true);
+      BOOST_CHECK(model.get_chord_newton());
+    }),
+    [](const SolverRun& reference, const SolverRun& run)
+    {
+      // Newton factorizes the jacobian at each iteration, the chord method reuses it while the residual decreases fast enough
+      BOOST_CHECK_EQUAL(reference.statistics.nb_factorizations, reference.statistics.nb_iterations);
+      BOOST_CHECK_GT(run.statistics.nb_factorizations, 0);
+      BOOST_CHECK_LT(run.statistics.nb_factorizations, run.statistics.nb_iterations);
+      BOOST_CHECK_LT(run.statistics.nb_factorizations * 2, reference.statistics.nb_factorizations);
+    }});
+  options.push_back({"constant gradient", create_sine(5), PROCESSSIZE, 1e-10,
+    run_clipper([](ATK::DynamicModellerFilter<double>& model)
+    {
+      model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+    }),
+    run_clipper([&counting](ATK::DynamicModellerFilter<double>& model)
+    {
+      auto conductance = std::make_unique<CountingConductance>(1e-4);
+      counting = conductance.get();
+      model.add_component(std::move(conductance), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+    }),
+    [&counting](const SolverRun&, const SolverRun& run)
+    {
+      // The constant stamp gives the same jacobian, it is only computed when the steady state is set up, not at each iteration
+      BOOST_CHECK_GT(run.statistics.nb_iterations, PROCESSSIZE);
+      BOOST_CHECK_GT(counting->get_nb_gradients(), 0);
+      BOOST_CHECK_LT(10 * counting->get_nb_gradients(), run.statistics.nb_iterations);
+    }});
+  for(auto predictor: {ATK::PredictorType::Linear, ATK::PredictorType::Quadratic})
+  {
+    options.push_back({predictor == ATK::PredictorType::Linear ? "linear predictor" : "quadratic predictor", create_sine(5), PROCESSSIZE, 1e-4, default_clipper,
+      run_clipper([predictor](ATK::DynamicModellerFilter<double>& model)
+      {
+        model.set_predictor(predictor);
+        BOOST_CHECK(model.get_predictor() == predictor);
+      }),
+      [](const SolverRun& reference, const SolverRun& run)
+      {
+        // The extrapolation of the smooth sine is a better initial guess than the previous state
+        BOOST_CHECK_LT(run.statistics.nb_iterations, reference.statistics.nb_iterations);
+      }});
+  }
+  options.push_back({"line search", create_sine(48), PROCESSSIZE, 1e-4, default_clipper,
+    run_clipper([](ATK::DynamicModellerFilter<double>& model)
+    {
+      model.set_newton_strategy(ATK::NewtonStrategy::LineSearch);
+      BOOST_CHECK(model.get_newton_strategy() == ATK::NewtonStrategy::LineSearch);
+    }),
+    [](const SolverRun& reference, const SolverRun& run)
+    {
+      // The full Newton updates are tried first, big swings don't need as many iterations as with the clamped updates
+      BOOST_CHECK_LT(run.statistics.nb_iterations, reference.statistics.nb_iterations);
+    }});
+  // Only the step is split, the samples before are identical
+  options.push_back({"sub steps", step, PROCESSSIZE / 2, 0, default_clipper,
+    run_clipper([](ATK::DynamicModellerFilter<double>& model)
+    {
+      model.set_max_substeps(8);
+      BOOST_CHECK_EQUAL(model.get_max_substeps(), 8);
+    }),
+    [](const SolverRun& reference, const SolverRun& run)
+    {
+      BOOST_CHECK_GT(reference.statistics.nb_not_converged, 0);
+      BOOST_CHECK_GT(run.statistics.nb_substepped, 0);
+      BOOST_CHECK_LE(run.statistics.nb_substepped, reference.statistics.nb_not_converged);
+    }});
+  for(bool mixed_precision: {false, true})
+  {
+    options.push_back({mixed_precision ? "mixed precision" : "single precision", create_sine(5), PROCESSSIZE, 1e-5, default_clipper,
+      run_clipper<float>([mixed_precision](ATK::DynamicModellerFilter<float>& model)
+      {
+        model.set_mixed_precision(mixed_precision);
+        BOOST_CHECK_EQUAL(model.get_mixed_precision(), mixed_precision);
+      }),
+      [](const SolverRun& reference, const SolverRun& run)
+      {
+        // The tolerance of the Newton iterations is reached in single precision without many more iterations
+        BOOST_CHECK_LE(run.statistics.nb_iterations, 2 * reference.statistics.nb_iterations);
+      }});
+  }
+
+  for(const auto& option: options)
+  {
+    BOOST_TEST_CONTEXT("Solver option: " << option.name)
+    {
+      auto reference = option.run_reference(option.data);
+      auto run = option.run(option.data);
+      BOOST_REQUIRE_EQUAL(run.outputs.size(), reference.outputs.size());
+      for(gsl::index j = 0; j < static_cast<gsl::index>(run.outputs.size()); ++j)
+      {
+        for(gsl::index i = 0; i < option.compared_samples; ++i)
+        {
+          BOOST_CHECK_LE(std::abs(run.outputs[j][i] - reference.outputs[j][i]), option.tolerance);
+        }
+      }
+      BOOST_CHECK_EQUAL(run.statistics.nb_samples, PROCESSSIZE);
+      BOOST_CHECK_EQUAL(run.statistics.nb_not_converged, 0);
+      option.check(reference, run);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_chord_newton_bad_threshold )
+{
+  auto model = create_clipper();
+  BOOST_CHECK_THROW(model->set_chord_newton(true, 1.5), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_constant_gradient )
+{
+  BOOST_CHECK(ATK::Resistor<double>(10000).has_constant_gradient());
+  BOOST_CHECK(ATK::Capacitor<double>(22e-9).has_constant_gradient());
+  BOOST_CHECK(ATK::Coil<double>(1e-3).has_constant_gradient());
+  BOOST_CHECK(!(ATK::Diode<double, 1, 1>(1e-12, 1).has_constant_gradient()));
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_stamp )
+{
+  // The voltages are static, so that the components can be stamped without solving the circuit
+  ATK::DynamicModellerFilter<double> model(0, 4, 0);
+  Eigen::Matrix<double, Eigen::Dynamic, 1> static_state(4);
+  static_state << 0, 0.55, 0.1, 0.62;
+  model.set_static_state(static_state);
+
+  std::vector<std::tuple<std::unique_ptr<ATK::Component<double>>, std::vector<std::tuple<ATK::PinType, gsl::index>>>> components;
+  auto pin = [](gsl::index index){return std::make_tuple(ATK::PinType::Static, index);};
+  components.emplace_back(std::make_unique<ATK::Resistor<double>>(1000), std::vector{pin(1), pin(2)});
+  components.emplace_back(std::make_unique<ATK::Capacitor<double>>(1e-6), std::vector{pin(1), pin(3)});
+  components.emplace_back(std::make_unique<ATK::Coil<double>>(1e-3), std::vector{pin(2), pin(3)});
+  components.emplace_back(std::make_unique<ATK::Diode<double, 1, 1>>(1e-12, 1), std::vector{pin(0), pin(1)});
+  components.emplace_back(std::make_unique<ATK::NPN<double>>(), std::vector{pin(3), pin(1), pin(0)});
+  components.emplace_back(std::make_unique<ATK::PNP<double>>(), std::vector{pin(0), pin(2), pin(3)});
+  components.emplace_back(std::make_unique<ATK::VoltageControlledCurrent<double>>(1e-3), std::vector{pin(1), pin(0), pin(3), pin(2)});
+  components.emplace_back(std::make_unique<ATK::ExponentialControlledCurrent<double>>(1e-12), std::vector{pin(2), pin(0), pin(3), pin(0)});
+
+  for(auto& [owned_component, pins]: components)
+  {
+    auto& component = *owned_component;
+    model.add_component(std::move(owned_component), pins);
+    // Every pin gets its own row, and every gradient its own value
+    gsl::index nb_pins = pins.size();
+    std::vector<gsl::index> current_slots(nb_pins);
+    std::vector<gsl::index> gradient_slots(nb_pins * nb_pins);
+    std::iota(current_slots.begin(), current_slots.end(), 0);
+    std::iota(gradient_slots.begin(), gradient_slots.end(), 0);
+    component.set_slots(std::move(current_slots), std::move(gradient_slots));
+    component.update_steady_state(1. / SAMPLING_RATE);
+
+    for(bool steady_state: {true, false})
+    {
+      component.precompute(steady_state);
+      Eigen::Matrix<double, Eigen::Dynamic, 1> eqs = Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(nb_pins);
+      std::vector<double> jacobian(nb_pins * nb_pins);
+      // The fused stamp gives the same currents and gradients as the per pin API
+      component.stamp(eqs, jacobian.data(), steady_state);
+      for(gsl::index i = 0; i < nb_pins; ++i)
+      {
+        BOOST_CHECK_CLOSE(eqs(i), component.get_current(i, steady_state), 1e-10);
+      }
+      for(gsl::index i = 0; i < nb_pins * nb_pins; ++i)
+      {
+        BOOST_CHECK_CLOSE(jacobian[i], component.get_gradient(i / nb_pins, i % nb_pins, steady_state), 1e-10);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_batched_exponentials )
+{
+  auto data = create_sine(1);
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  // Junctions of all types, so that the exponents of each one are gathered and scattered at different offsets
+  ATK::DynamicModellerFilter<double> model(5, 2, 1);
+  Eigen::Matrix<double, Eigen::Dynamic, 1> static_state(2);
+  static_state << 0, 5;
+  model.set_static_state(static_state);
+  std::vector<ATK::Component<double>*> junctions;
+  auto add_junction = [&](std::unique_ptr<ATK::Component<double>> component, std::vector<std::tuple<ATK::PinType, gsl::index>> pins)
+  {
+    junctions.push_back(component.get());
+    model.add_component(std::move(component), std::move(pins));
+  };
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  add_junction(std::make_unique<ATK::Diode<double, 1, 1>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  add_junction(std::make_unique<ATK::NPN<double>>(), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Static, 1), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  add_junction(std::make_unique<ATK::ExponentialControlledCurrent<double>>(1e-15), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Static, 1), std::make_tuple(ATK::PinType::Dynamic, 2)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 2), std::make_tuple(ATK::PinType::Static, 0)}});
+  add_junction(std::make_unique<ATK::PNP<double>>(), {{std::make_tuple(ATK::PinType::Dynamic, 3), std::make_tuple(ATK::PinType::Dynamic, 4), std::make_tuple(ATK::PinType::Static, 1)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100000), {{std::make_tuple(ATK::PinType::Dynamic, 3), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Dynamic, 4), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.enable_statistics(true);
+  process(model, generator);
+  BOOST_CHECK_EQUAL(model.get_statistics().nb_not_converged, 0);
+
+  // The last batch was computed for the final state, each junction computing its own exponentials gives the same currents and gradients
+  for(auto junction: junctions)
+  {
+    gsl::index nb_pins = junction->get_pins().size();
+    std::vector<double> currents;
+    std::vector<double> gradients;
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      currents.push_back(junction->get_current(i, false));
+      for(gsl::index j = 0; j < nb_pins; ++j)
+      {
+        gradients.push_back(junction->get_gradient(i, j, false));
+      }
+    }
+    junction->precompute(false);
+    for(gsl::index i = 0; i < nb_pins; ++i)
+    {
+      BOOST_CHECK_CLOSE(currents[i], junction->get_current(i, false), 1e-8);
+      for(gsl::index j = 0; j < nb_pins; ++j)
+      {
+        BOOST_CHECK_CLOSE(gradients[i * nb_pins + j], junction->get_gradient(i, j, false), 1e-8);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_linear )
+{
+  auto data = create_sine(5);
+  
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Capacitor<double>>(22e-9), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  process(model, generator);
+  BOOST_CHECK(model.is_linear());
+  
+  // Trapezoidal rule applied on the RC filter
+  double alpha = 10000 * 22e-9 * 2 * SAMPLING_RATE;
+  double previous_input = 0;
+  double previous_output = 0;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    double output = ((data[i] + previous_input) + (alpha - 1) * previous_output) / (alpha + 1);
+    BOOST_CHECK_SMALL(output - model.get_output_array(0)[i], 1e-8);
+    previous_input = data[i];
+    previous_output = output;
+  }
+  
+  ATK::InPointerFilter<double> generator_clipper(data.data(), 1, PROCESSSIZE, false);
+  generator_clipper.set_output_sampling_rate(SAMPLING_RATE);
+  auto clipper = create_clipper();
+  process(*clipper, generator_clipper);
+  BOOST_CHECK(!clipper->is_linear());
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_linear_coil )
+{
+  // The input through a resistor to a coil, the coil takes its current from the state solved for each sample
+  auto create_rl = []()
+  {
+    auto model = std::make_unique<ATK::DynamicModellerFilter<double>>(1, 1, 1);
+    model->add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model->add_component(std::make_unique<ATK::Coil<double>>(1e-3), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+    return model;
+  };
+  auto model = create_rl();
+  // A diode with a negligible current makes the circuit non linear, it is solved with Newton iterations
+  auto model_newton = create_rl();
+  model_newton->add_component(std::make_unique<ATK::Diode<double, 1, 0>>(1e-30, 1), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  compare_models(*model, *model_newton, create_sine(1), 1e-6);
+  BOOST_CHECK(model->is_linear());
+  BOOST_CHECK(!model_newton->is_linear());
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_reproducible )
+{
+  auto data = create_sine(5);
+  
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::InPointerFilter<double> generator_bis(data.data(), 1, PROCESSSIZE, false);
+  generator_bis.set_output_sampling_rate(SAMPLING_RATE);
+  
+  auto model = create_clipper();
+  process(*model, generator);
+  auto model_bis = create_clipper();
+  process(*model_bis, generator_bis);
+  
+  BOOST_CHECK_EQUAL(model->get_nb_components(), 3);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(model->get_output_array(0)[i], model_bis->get_output_array(0)[i]);
+    BOOST_CHECK_EQUAL(model->get_output_array(1)[i], model_bis->get_output_array(1)[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_junction_limiting )
+{
+  // Steps move the diode voltage far enough between two iterations to be limited
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i / 100) % 2 == 0 ? 5 : -5;
+  }
+
+  auto model = create_resistive_clipper();
+  model->enable_statistics(true);
+  auto model_limited = create_resistive_clipper();
+  model_limited->set_junction_limiting(true);
+  BOOST_CHECK(model_limited->get_junction_limiting());
+  model_limited->enable_statistics(true);
+  // The limitation changes the iterations, not the solution
+  compare_models(*model, *model_limited, data, 1e-6);
+
+  auto statistics = model_limited->get_statistics();
+  BOOST_CHECK_GT(statistics.nb_limited_iterations, 0);
+  BOOST_CHECK_EQUAL(statistics.nb_not_converged, 0);
+  BOOST_CHECK_EQUAL(model->get_statistics().nb_limited_iterations, 0);
+  // The diodes stay below one volt, the steps only clip them
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_CHECK_LT(std::abs(model_limited->get_output_array(0)[i]), 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_limit_junction_voltage )
+{
+  double x_crit = ATK::junction_critical_voltage(1e-12, 26e-3);
+  // Small updates and updates below the critical voltage are not limited
+  BOOST_CHECK_EQUAL(ATK::limit_junction_voltage(x_crit + 1, x_crit, x_crit), x_crit + 1);
+  BOOST_CHECK_EQUAL(ATK::limit_junction_voltage(x_crit - 10, 0., x_crit), x_crit - 10);
+  // Big updates are logarithmically compressed
+  BOOST_CHECK_CLOSE(ATK::limit_junction_voltage(x_crit + 10, x_crit, x_crit), x_crit + std::log(11.), 1e-10);
+  BOOST_CHECK_CLOSE(ATK::limit_junction_voltage(100., -1., x_crit), std::log(100.), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_line_search_junction_limiting )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i / 100) % 2 == 0 ? 48 : -48;
+  }
+
+  // The trial points of the line search don't move the limitation of the junctions
+  auto model = create_resistive_clipper();
+  auto model_limited = create_resistive_clipper();
+  model_limited->set_newton_strategy(ATK::NewtonStrategy::LineSearch);
+  model_limited->set_junction_limiting(true);
+  model_limited->enable_statistics(true);
+  compare_models(*model, *model_limited, data, 1e-6);
+
+  auto statistics = model_limited->get_statistics();
+  BOOST_CHECK_GT(statistics.nb_limited_iterations, 0);
+  BOOST_CHECK_EQUAL(statistics.nb_not_converged, 0);
+  // Only the 10 steps need iterations, limiting against rejected trial points would slow them down
+  BOOST_CHECK_LT(statistics.nb_iterations, PROCESSSIZE / 5);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_statistics )
+{
+  auto data = create_sine(5);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  auto model = create_clipper();
+  model->enable_statistics(true);
+  BOOST_CHECK(model->get_statistics_enabled());
+  process(*model, generator);
+
+  auto statistics = model->get_statistics();
+  BOOST_CHECK_EQUAL(statistics.nb_samples, PROCESSSIZE);
+  BOOST_CHECK_EQUAL(statistics.nb_not_converged, 0);
+  gsl::index nb_samples = 0;
+  for(auto count: statistics.iterations_histogram)
+  {
+    nb_samples += count;
+  }
+  BOOST_CHECK_EQUAL(nb_samples, PROCESSSIZE);
+  BOOST_CHECK_GE(statistics.nb_iterations, PROCESSSIZE);
+  BOOST_CHECK_LT(statistics.max_residual, 1e-6);
+  BOOST_CHECK_GT(statistics.nanoseconds_per_sample, 0);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_statistics_bins )
+{
+  using Statistics = ATK::SolverStatistics<double>;
+  BOOST_CHECK_EQUAL(Statistics::get_bin(0), 0);
+  BOOST_CHECK_EQUAL(Statistics::get_bin(1), 1);
+  BOOST_CHECK_EQUAL(Statistics::get_bin(3), 2);
+  BOOST_CHECK_EQUAL(Statistics::get_bin(4), 3);
+  BOOST_CHECK_EQUAL(Statistics::get_bin(200), Statistics::NB_ITERATION_BINS - 1);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_realtime_budget )
+{
+  auto data = create_sine(48);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::InPointerFilter<double> generator_budget(data.data(), 1, PROCESSSIZE, false);
+  generator_budget.set_output_sampling_rate(SAMPLING_RATE);
+
+  auto model = create_clipper();
+  model->set_realtime_budget(200);
+  process(*model, generator);
+  BOOST_CHECK_EQUAL(model->get_nb_degraded_samples(), 0);
+
+  auto model_budget = create_clipper();
+  model_budget->set_realtime_budget(3, 0, 2);
+  BOOST_CHECK_EQUAL(model_budget->get_iterations_budget(), 3);
+  BOOST_CHECK_EQUAL(model_budget->get_degraded_iterations(), 2);
+  model_budget->enable_statistics(true);
+  process(*model_budget, generator_budget);
+
+  auto statistics = model_budget->get_statistics();
+  BOOST_CHECK_GT(model_budget->get_nb_degraded_samples(), 0);
+  BOOST_CHECK_EQUAL(statistics.nb_degraded, model_budget->get_nb_degraded_samples());
+  // Each sample ends with an evaluation of its state that is counted in the budget
+  BOOST_CHECK_LE(statistics.nb_iterations + statistics.nb_samples, 3 * PROCESSSIZE);
+  // The residual of the degraded samples is the one of their kept state
+  BOOST_CHECK_GT(statistics.max_residual, 1e-6);
+  BOOST_CHECK(std::isfinite(statistics.max_residual));
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_CHECK(std::isfinite(model_budget->get_output_array(0)[i]));
+    BOOST_CHECK_LT(std::abs(model_budget->get_output_array(1)[i]), 48);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_realtime_budget_line_search )
+{
+  // The line search evaluates the equations at its trial points, the kept state must come with its own residual
+  auto data = create_sine(48);
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  auto model = create_resistive_clipper();
+  model->set_newton_strategy(ATK::NewtonStrategy::LineSearch);
+  model->set_realtime_budget(3, 0, 2);
+  model->enable_statistics(true);
+  model->set_input_sampling_rate(SAMPLING_RATE);
+  model->set_output_sampling_rate(SAMPLING_RATE);
+  model->set_input_port(0, &generator, 0);
+  model->setup();
+
+  // Blocks of one sample, the statistics hold the residual of the state of this sample
+  gsl::index nb_degraded = 0;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    model->process(1);
+    auto statistics = model->get_statistics();
+    nb_degraded += statistics.nb_degraded;
+
+    double voltage = model->get_output_array(0)[0];
+    double resistor_current = (data[i] - voltage) / 100;
+    double diodes_current = 1e-12 * (std::exp(voltage / 26e-3) - std::exp(-voltage / 26e-3));
+    double residual = std::abs(resistor_current - diodes_current);
+    BOOST_CHECK_SMALL(statistics.max_residual - residual, 1e-6 * (std::abs(resistor_current) + std::abs(diodes_current)) + 1e-12);
+  }
+  BOOST_CHECK_GT(nb_degraded, 0);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_realtime_budget_bad_parameters )
+{
+  auto model = create_clipper();
+  BOOST_CHECK_THROW(model->set_realtime_budget(-1), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model->set_realtime_budget(2, 0, 0), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model->set_realtime_budget(2, 0, 4), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model->set_realtime_budget(2, 0, 2), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_substeps_bad_value )
+{
+  auto model = create_clipper();
+  BOOST_CHECK_THROW(model->set_max_substeps(0), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model->set_max_substeps(3), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_oversampling )
+{
+  auto data = create_sine(1);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Capacitor<double>>(22e-9), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.set_oversampling(4);
+  BOOST_CHECK_EQUAL(model.get_oversampling(), 4);
+  process(model, generator);
+  BOOST_CHECK_EQUAL(model.get_latency(), 15);
+
+  // Once the transient is gone, the output is the RC response to the sine, delayed by the oversampling filters
+  double omega = 2 * boost::math::constants::pi<double>() * 1000;
+  double rc = 10000 * 22e-9;
+  double gain = 1 / std::sqrt(1 + omega * omega * rc * rc);
+  for(gsl::index i = PROCESSSIZE / 4; i < PROCESSSIZE; ++i)
+  {
+    double output = gain * std::sin(omega * (i - model.get_latency()) / SAMPLING_RATE - std::atan(omega * rc));
+    BOOST_CHECK_SMALL(output - model.get_output_array(0)[i], 1e-3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_oversampling_latency )
+{
+  // The delay of an impulse through a resistive divider is the latency of the filters, whatever the factor
+  for(gsl::index oversampling: {1, 2, 3, 4, 8})
+  {
+    std::array<double, PROCESSSIZE> impulse{};
+    impulse[100] = 1;
+    ATK::InPointerFilter<double> generator(impulse.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    ATK::DynamicModellerFilter<double> model(1, 1, 1);
+    model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model.set_oversampling(oversampling);
+    process(model, generator);
+    BOOST_CHECK_EQUAL(model.get_latency(), oversampling == 1 ? 0 : 15);
+
+    // The filters are symmetric, the response is centered on the delayed impulse
+    const double* output = model.get_output_array(0);
+    gsl::index peak = std::max_element(output, output + PROCESSSIZE) - output;
+    BOOST_CHECK_EQUAL(peak, 100 + model.get_latency());
+    for(gsl::index i = 1; i < 10; ++i)
+    {
+      BOOST_CHECK_SMALL(output[peak - i] - output[peak + i], 1e-12);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_oversampling_bad_factor )
+{
+  auto model = create_clipper();
+  BOOST_CHECK_THROW(model->set_oversampling(0), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_clone )
+{
+  auto data = create_sine(5);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  auto model = create_clipper();
+  model->set_predictor(ATK::PredictorType::Linear);
+  process(*model, generator);
+
+  // The clone continues from the state of the original model
+  auto clone = model->clone_dynamic();
+  BOOST_CHECK_EQUAL(clone->get_nb_components(), model->get_nb_components());
+  BOOST_CHECK(clone->get_predictor() == ATK::PredictorType::Linear);
+  BOOST_CHECK_EQUAL(clone->get_dynamic_state(), model->get_dynamic_state());
+
+  ATK::InPointerFilter<double> generator_next(data.data(), 1, PROCESSSIZE, false);
+  generator_next.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::InPointerFilter<double> generator_clone(data.data(), 1, PROCESSSIZE, false);
+  generator_clone.set_output_sampling_rate(SAMPLING_RATE);
+  model->set_input_port(0, &generator_next, 0);
+  model->process(PROCESSSIZE);
+  clone->set_input_port(0, &generator_clone, 0);
+  clone->process(PROCESSSIZE);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_CHECK_EQUAL(model->get_output_array(0)[i], clone->get_output_array(0)[i]);
+    BOOST_CHECK_EQUAL(model->get_output_array(1)[i], clone->get_output_array(1)[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_clone_not_cloneable )
+{
+  // The conductance of the tests doesn't override clone()
+  auto model = create_clipper();
+  model->add_component(std::make_unique<CountingConductance>(1e-4), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  BOOST_CHECK_THROW(model->clone_dynamic(), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( ModellerFilter_default_clone_snapshot )
+{
+  // Modellers that don't override clone() and the snapshots can still be written, the calls throw
+  MinimalModeller model;
+  std::array<char, 16> buffer;
+  BOOST_CHECK_THROW(model.clone(), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model.get_snapshot_size(), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model.save_snapshot(buffer.data(), buffer.size()), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model.restore_snapshot(buffer.data(), buffer.size()), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_clone_chord )
+{
+  auto data = create_sine(5);
+
+  for(auto solver_type: {ATK::SolverType::Dense, ATK::SolverType::Sparse})
+  {
+    ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    auto model = create_clipper();
+    model->set_solver_type(solver_type);
+    model->set_chord_newton(true);
+    process(*model, generator);
+
+    // The clone reuses the same factorization as the original model
+    auto clone = model->clone_dynamic();
+    BOOST_CHECK(clone->get_chord_newton());
+
+    ATK::InPointerFilter<double> generator_next(data.data(), 1, PROCESSSIZE, false);
+    generator_next.set_output_sampling_rate(SAMPLING_RATE);
+    ATK::InPointerFilter<double> generator_clone(data.data(), 1, PROCESSSIZE, false);
+    generator_clone.set_output_sampling_rate(SAMPLING_RATE);
+    model->set_input_port(0, &generator_next, 0);
+    model->process(PROCESSSIZE);
+    clone->set_input_port(0, &generator_clone, 0);
+    clone->process(PROCESSSIZE);
+
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      BOOST_CHECK_EQUAL(model->get_output_array(0)[i], clone->get_output_array(0)[i]);
+      BOOST_CHECK_EQUAL(model->get_output_array(1)[i], clone->get_output_array(1)[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_lockstep )
+{
+  auto model = create_clipper();
+  model->set_input_sampling_rate(SAMPLING_RATE);
+  model->set_output_sampling_rate(SAMPLING_RATE);
+  model->setup();
+
+  ATK::LockstepModellerFilter<double> lockstep(*model, 4);
+  BOOST_CHECK_EQUAL(lockstep.get_nb_lanes(), 4);
+  check_lockstep(lockstep, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_lockstep_custom_equation )
+{
+  // The clipped voltage is amplified on a load, the voltage gain replaces the Kirchhoff equation of its output
+  ATK::DynamicModellerFilter<double> model(3, 1, 1);
+  model.add_component(std::make_unique<ATK::Diode<double, 1, 1>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Capacitor<double>>(22e-9), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  model.add_component(std::make_unique<ATK::VoltageGain<double>>(2), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 2), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 2), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_sampling_rate(SAMPLING_RATE);
+  model.set_output_sampling_rate(SAMPLING_RATE);
+  model.setup();
+  BOOST_CHECK(!model.is_linear());
+
+  ATK::LockstepModellerFilter<double> lockstep(model, 3);
+  check_lockstep(lockstep, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_lockstep_linear )
+{
+  // The decompositions of the linear instances are kept until one of their resistors changes
+  ATK::DynamicModellerFilter<double> model(2, 1, 1);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Coil<double>>(1e-3), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::VoltageGain<double>>(2), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_sampling_rate(SAMPLING_RATE);
+  model.set_output_sampling_rate(SAMPLING_RATE);
+  model.setup();
+  BOOST_CHECK(model.is_linear());
+
+  ATK::LockstepModellerFilter<double> lockstep(model, 3);
+  lockstep.get_lane(1).set_parameter(0, 200);
+  check_lockstep(lockstep, 1e-6, [](ATK::DynamicModellerFilter<double>& lane_model, gsl::index lane)
+  {
+    if(lane == 2)
+    {
+      lane_model.set_parameter(0, 50);
+    }
+  });
+  BOOST_CHECK_EQUAL(lockstep.get_lane(1).get_parameter(0), 200);
+  BOOST_CHECK_EQUAL(lockstep.get_lane(2).get_parameter(0), 50);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_lockstep_singular )
+{
+  // The last pin has no component, the jacobians are singular and the instances are solved by their own solver
+  ATK::DynamicModellerFilter<double> model(3, 1, 1);
+  model.add_component(std::make_unique<ATK::Diode<double, 1, 1>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Capacitor<double>>(22e-9), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  model.set_input_sampling_rate(SAMPLING_RATE);
+  model.set_output_sampling_rate(SAMPLING_RATE);
+  model.setup();
+
+  ATK::LockstepModellerFilter<double> lockstep(model, 2);
+  check_lockstep(lockstep, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_lockstep_unsupported )
+{
+  auto model = create_clipper();
+  model->set_newton_strategy(ATK::NewtonStrategy::LineSearch);
+  BOOST_CHECK_THROW(ATK::LockstepModellerFilter<double>(*model, 2), ATK::RuntimeError);
+
+  model->set_newton_strategy(ATK::NewtonStrategy::Clamped);
+  model->set_chord_newton(true);
+  BOOST_CHECK_THROW(ATK::LockstepModellerFilter<double>(*model, 2), ATK::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache )
+{
+  auto data = create_sine(1);
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+
+  auto reference = create_biased_circuit(5);
+  Eigen::Matrix<double, Eigen::Dynamic, 1> steady_state = reference->get_dynamic_state();
+  BOOST_CHECK_GT(steady_state(1), 0);
+
+  // The first modeller computes the steady state and fills the cache
+  auto first = create_biased_circuit(5, cache);
+  BOOST_CHECK(first->get_steady_state_cache() == cache);
+  BOOST_CHECK_EQUAL(cache->size(), 1);
+  BOOST_CHECK_EQUAL(first->get_dynamic_state(), steady_state);
+
+  // The second one restores it, with the state of the coil, and behaves the same
+  auto second = create_biased_circuit(5, cache);
+  BOOST_CHECK_EQUAL(second->get_steady_state_key(), first->get_steady_state_key());
+  BOOST_CHECK_EQUAL(cache->size(), 1);
+  BOOST_CHECK_EQUAL(second->get_dynamic_state(), steady_state);
+
+  ATK::InPointerFilter<double> generator_reference(data.data(), 1, PROCESSSIZE, false);
+  generator_reference.set_output_sampling_rate(SAMPLING_RATE);
+  reference->set_input_port(0, &generator_reference, 0);
+  reference->process(PROCESSSIZE);
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  second->set_input_port(0, &generator, 0);
+  second->process(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(second->get_output_array(0)[i], reference->get_output_array(0)[i]);
+    BOOST_REQUIRE_EQUAL(second->get_output_array(1)[i], reference->get_output_array(1)[i]);
+  }
+
+  // Another bias is another circuit
+  auto other = create_biased_circuit(6, cache);
+  BOOST_CHECK_NE(other->get_steady_state_key(), first->get_steady_state_key());
+  BOOST_CHECK_EQUAL(cache->size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache_hit )
+{
+  auto reference = create_biased_circuit(5);
+
+  // A cached state is used as is, without any computation
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  ATK::SteadyStateCache<double>::Entry entry;
+  entry.description = reference->get_steady_state_description();
+  entry.dynamic_state.setConstant(2, 0.25);
+  entry.component_states.assign(2 + 2 + 1, 0);
+  cache->insert(reference->get_steady_state_key(), entry);
+  auto model = create_biased_circuit(5, cache);
+  BOOST_CHECK_EQUAL(model->get_dynamic_state(), entry.dynamic_state);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache_collision )
+{
+  auto reference = create_biased_circuit(5);
+
+  // The state of another circuit stored with the same key is not used, and is replaced
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  ATK::SteadyStateCache<double>::Entry entry;
+  entry.description = create_biased_circuit(6)->get_steady_state_description();
+  entry.dynamic_state.setConstant(2, 0.25);
+  entry.component_states.assign(2 + 2 + 1, 0);
+  cache->insert(reference->get_steady_state_key(), entry);
+  auto model = create_biased_circuit(5, cache);
+  BOOST_CHECK_EQUAL(model->get_dynamic_state(), reference->get_dynamic_state());
+  BOOST_REQUIRE(cache->find(reference->get_steady_state_key(), entry));
+  BOOST_CHECK(entry.description == reference->get_steady_state_description());
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache_junction_limiting )
+{
+  // The limitation changes the iterations of the steady state, a limited circuit doesn't get the state of an unlimited one
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  auto model = create_biased_circuit(5, cache);
+  auto model_limited = create_biased_circuit(5, cache, true);
+  BOOST_CHECK_NE(model_limited->get_steady_state_key(), model->get_steady_state_key());
+  BOOST_CHECK(model_limited->get_steady_state_description() != model->get_steady_state_description());
+  BOOST_CHECK_EQUAL(cache->size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache_not_converged )
+{
+  // A steady state that didn't converge is not shared
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_steady_state_cache(cache);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<UndefinedCurrent>(), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.set_input_sampling_rate(SAMPLING_RATE);
+  model.set_output_sampling_rate(SAMPLING_RATE);
+  BOOST_CHECK_EQUAL(cache->size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_description_values )
+{
+  // The values of the components are part of the description, not only a hash of them
+  auto model = create_biased_circuit(5);
+  auto description = model->get_steady_state_description();
+  for(double value: {1000., 2000., 1e-3, 100e-9})
+  {
+    BOOST_CHECK_NE(description.find(std::string(reinterpret_cast<const char*>(&value), sizeof(value))), std::string::npos);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_steady_state_cache_save )
+{
+  auto cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  auto model = create_biased_circuit(5, cache);
+
+  std::stringstream stream;
+  cache->save(stream);
+  auto loaded_cache = std::make_shared<ATK::SteadyStateCache<double>>();
+  loaded_cache->load(stream);
+  BOOST_CHECK_EQUAL(loaded_cache->size(), 1);
+  ATK::SteadyStateCache<double>::Entry entry;
+  BOOST_REQUIRE(loaded_cache->find(model->get_steady_state_key(), entry));
+  BOOST_CHECK(entry.description == model->get_steady_state_description());
+  BOOST_CHECK_EQUAL(entry.dynamic_state, model->get_dynamic_state());
+
+  std::stringstream bad_stream("not a cache");
+  BOOST_CHECK_THROW(loaded_cache->load(bad_stream), ATK::RuntimeError);
+  std::stringstream float_stream;
+  ATK::SteadyStateCache<float>().save(float_stream);
+  BOOST_CHECK_THROW(loaded_cache->load(float_stream), ATK::RuntimeError);
+}
+
+namespace
+{
+  void check_snapshot(gsl::index oversampling)
+  {
+    auto data = create_sine(5);
+    constexpr gsl::index HALFSIZE = PROCESSSIZE / 2;
+
+    auto model = create_biased_circuit(5);
+    model->set_oversampling(oversampling);
+    ATK::InPointerFilter<double> generator(data.data(), 1, HALFSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+    model->set_input_port(0, &generator, 0);
+    model->process(HALFSIZE);
+
+    std::vector<char> snapshot(model->get_snapshot_size());
+    model->save_snapshot(snapshot.data(), snapshot.size());
+
+    ATK::InPointerFilter<double> generator_end(data.data() + HALFSIZE, 1, HALFSIZE, false);
+    generator_end.set_output_sampling_rate(SAMPLING_RATE);
+    model->set_input_port(0, &generator_end, 0);
+    model->process(HALFSIZE);
+    std::vector<double> reference(model->get_output_array(1), model->get_output_array(1) + HALFSIZE);
+
+    // Another instance of the circuit, with other parameters, continues from the snapshot
+    auto restored = create_biased_circuit(5);
+    restored->set_oversampling(oversampling);
+    restored->set_parameter(0, 500);
+    restored->restore_snapshot(snapshot.data(), snapshot.size());
+    BOOST_CHECK_EQUAL(restored->get_parameter(0), 1000);
+    ATK::InPointerFilter<double> generator_restored(data.data() + HALFSIZE, 1, HALFSIZE, false);
+    generator_restored.set_output_sampling_rate(SAMPLING_RATE);
+    restored->set_input_port(0, &generator_restored, 0);
+    restored->process(HALFSIZE);
+
+    // The original instance goes back to the snapshot in place
+    model->restore_snapshot(snapshot.data(), snapshot.size());
+    ATK::InPointerFilter<double> generator_again(data.data() + HALFSIZE, 1, HALFSIZE, false);
+    generator_again.set_output_sampling_rate(SAMPLING_RATE);
+    model->set_input_port(0, &generator_again, 0);
+    model->process(HALFSIZE);
+
+    for(gsl::index i = 0; i < HALFSIZE; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(restored->get_output_array(1)[i], reference[i]);
+      BOOST_REQUIRE_EQUAL(model->get_output_array(1)[i], reference[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_snapshot )
+{
+  check_snapshot(1);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_snapshot_oversampling )
+{
+  check_snapshot(2);
+}
+
+BOOST_AUTO_TEST_CASE( DynamicModellerFilter_snapshot_mismatch )
+{
+  auto model = create_biased_circuit(5);
+  std::vector<char> snapshot(model->get_snapshot_size());
+  model->save_snapshot(snapshot.data(), snapshot.size());
+  BOOST_CHECK_THROW(model->save_snapshot(snapshot.data(), snapshot.size() - 1), ATK::RuntimeError);
+  BOOST_CHECK_THROW(model->restore_snapshot(snapshot.data(), snapshot.size() - 1), ATK::RuntimeError);
+
+  // Another circuit
+  auto clipper = create_clipper();
+  clipper->set_input_sampling_rate(SAMPLING_RATE);
+  clipper->set_output_sampling_rate(SAMPLING_RATE);
+  BOOST_CHECK_THROW(clipper->restore_snapshot(snapshot.data(), snapshot.size()), ATK::RuntimeError);
+
+  auto oversampled = create_biased_circuit(5);
+  oversampled->set_oversampling(2);
+  BOOST_CHECK_THROW(oversampled->restore_snapshot(snapshot.data(), snapshot.size()), ATK::RuntimeError);
+
+  snapshot[0] = 'X';
+  BOOST_CHECK_THROW(model->restore_snapshot(snapshot.data(), snapshot.size()), ATK::RuntimeError);
+}
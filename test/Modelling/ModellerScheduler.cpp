@@ -0,0 +1,172 @@
+/**
+ * \ file ModellerScheduler.cpp
+ */
+
+#include <array>
+#include <vector>
+
+#include <ATK/config.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/ModellerScheduler.h>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include "AllocationCounter.h"
+#include "ModellerTestCircuits.h"
+
+static constexpr gsl::index BLOCKSIZE = 100;
+static constexpr gsl::index NB_CHANNELS = 7;
+
+namespace
+{
+  /// A channel of a session: its signal, its generator and its modeller
+  struct Channel
+  {
+    std::array<double, PROCESSSIZE> data;
+    std::unique_ptr<ATK::InPointerFilter<double>> generator;
+    std::unique_ptr<ATK::DynamicModellerFilter<double>> model;
+
+    explicit Channel(double amplitude)
+    :data(create_sine(amplitude)), generator(std::make_unique<ATK::InPointerFilter<double>>(data.data(), 1, PROCESSSIZE, false)), model(create_clipper())
+    {
+      generator->set_output_sampling_rate(SAMPLING_RATE);
+      model->set_input_sampling_rate(SAMPLING_RATE);
+      model->set_output_sampling_rate(SAMPLING_RATE);
+      model->set_input_port(0, generator.get(), 0);
+      model->setup();
+    }
+  };
+
+  /// A filter that fails every block
+  class ThrowingFilter final: public ATK::TypedBaseFilter<double>
+  {
+  public:
+    ThrowingFilter()
+    :TypedBaseFilter<double>(0, 1)
+    {
+      set_input_sampling_rate(SAMPLING_RATE);
+      set_output_sampling_rate(SAMPLING_RATE);
+    }
+
+  protected:
+    void process_impl(gsl::index size) const override
+    {
+      throw ATK::RuntimeError("Failing filter");
+    }
+  };
+
+  void check_scheduler(gsl::index nb_threads)
+  {
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::vector<std::unique_ptr<Channel>> references;
+    ATK::ModellerScheduler scheduler(nb_threads);
+    BOOST_CHECK_EQUAL(scheduler.get_nb_threads(), nb_threads);
+    for(gsl::index i = 0; i < NB_CHANNELS; ++i)
+    {
+      channels.push_back(std::make_unique<Channel>(i + 1));
+      references.push_back(std::make_unique<Channel>(i + 1));
+      scheduler.add_filter(channels.back()->model.get());
+    }
+    BOOST_CHECK_EQUAL(scheduler.get_nb_filters(), NB_CHANNELS);
+
+    for(gsl::index block = 0; block < PROCESSSIZE / BLOCKSIZE; ++block)
+    {
+      scheduler.process(BLOCKSIZE);
+
+      for(gsl::index i = 0; i < NB_CHANNELS; ++i)
+      {
+        references[i]->model->process(BLOCKSIZE);
+        for(gsl::index j = 0; j < BLOCKSIZE; ++j)
+        {
+          BOOST_REQUIRE_EQUAL(channels[i]->model->get_output_array(0)[j], references[i]->model->get_output_array(0)[j]);
+          BOOST_REQUIRE_EQUAL(channels[i]->model->get_output_array(1)[j], references[i]->model->get_output_array(1)[j]);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_no_worker )
+{
+  check_scheduler(0);
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_workers )
+{
+  check_scheduler(3);
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_no_allocation, * boost::unit_test::enable_if<ATK_MODELLING_TEST_COUNT_ALLOCATIONS>() )
+{
+  std::vector<std::unique_ptr<Channel>> channels;
+  ATK::ModellerScheduler scheduler(3);
+  for(gsl::index i = 0; i < NB_CHANNELS; ++i)
+  {
+    channels.push_back(std::make_unique<Channel>(i + 1));
+    scheduler.add_filter(channels.back()->model.get());
+  }
+  scheduler.process(BLOCKSIZE);
+
+  // The workers count their allocations as well
+  gsl::index allocations = nb_allocations;
+  for(gsl::index block = 1; block < PROCESSSIZE / BLOCKSIZE; ++block)
+  {
+    scheduler.process(BLOCKSIZE);
+  }
+  BOOST_CHECK_EQUAL(nb_allocations - allocations, 0);
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_remove_filter )
+{
+  Channel channel(1);
+  ATK::ModellerScheduler scheduler(2);
+  scheduler.add_filter(channel.model.get());
+  scheduler.remove_filter(channel.model.get());
+  BOOST_CHECK_EQUAL(scheduler.get_nb_filters(), 0);
+  scheduler.process(PROCESSSIZE);
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_exception )
+{
+  std::vector<std::unique_ptr<Channel>> channels;
+  std::vector<std::unique_ptr<Channel>> references;
+  ThrowingFilter failing_filter;
+  ATK::ModellerScheduler scheduler(2);
+  for(gsl::index i = 0; i < NB_CHANNELS; ++i)
+  {
+    channels.push_back(std::make_unique<Channel>(i + 1));
+    references.push_back(std::make_unique<Channel>(i + 1));
+    scheduler.add_filter(channels.back()->model.get());
+    if(i == NB_CHANNELS / 2)
+    {
+      scheduler.add_filter(&failing_filter);
+    }
+  }
+
+  // The error is thrown again once the other filters processed the block
+  BOOST_CHECK_THROW(scheduler.process(BLOCKSIZE), ATK::RuntimeError);
+  for(gsl::index i = 0; i < NB_CHANNELS; ++i)
+  {
+    references[i]->model->process(BLOCKSIZE);
+    for(gsl::index j = 0; j < BLOCKSIZE; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(channels[i]->model->get_output_array(0)[j], references[i]->model->get_output_array(0)[j]);
+    }
+  }
+
+  // The next blocks don't keep the error
+  scheduler.remove_filter(&failing_filter);
+  BOOST_CHECK_NO_THROW(scheduler.process(BLOCKSIZE));
+}
+
+BOOST_AUTO_TEST_CASE( ModellerScheduler_bad_threads )
+{
+  BOOST_CHECK_THROW(ATK::ModellerScheduler scheduler(-1), ATK::RuntimeError);
+}
@@ -0,0 +1,98 @@
+/**
+ * \ file ModellerTestCircuits.h
+ * Signals and circuits shared by the tests of the modellers
+ */
+
+#ifndef ATK_MODELLING_TEST_MODELLERTESTCIRCUITS_H
+#define ATK_MODELLING_TEST_MODELLERTESTCIRCUITS_H
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include <boost/math/constants/constants.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <ATK/Core/InPointerFilter.h>
+
+#include <ATK/Modelling/Capacitor.h>
+#include <ATK/Modelling/Diode.h>
+#include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/Resistor.h>
+
+static constexpr gsl::index PROCESSSIZE = 1000;
+static constexpr gsl::index SAMPLING_RATE = 48000;
+
+namespace
+{
+  /// A 1kHz sine of PROCESSSIZE samples
+  std::array<double, PROCESSSIZE> create_sine(double amplitude)
+  {
+    std::array<double, PROCESSSIZE> data;
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      data[i] = amplitude * std::sin(2 * i * boost::math::constants::pi<double>() / SAMPLING_RATE * 1000);
+    }
+    return data;
+  }
+
+  /// Antiparallel diodes to the ground, driven by the input through a capacitor and a resistor
+  template<typename DataType = double>
+  std::unique_ptr<ATK::DynamicModellerFilter<DataType>> create_clipper()
+  {
+    auto model = std::make_unique<ATK::DynamicModellerFilter<DataType>>(2, 1, 1);
+
+    model->add_component(std::make_unique<ATK::Diode<DataType, 1, 1>>(1e-12, 1), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model->add_component(std::make_unique<ATK::Capacitor<DataType>>(22e-9), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+    model->add_component(std::make_unique<ATK::Resistor<DataType>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+
+    return model;
+  }
+
+  /// Sets up a modeller at the test sampling rate and processes PROCESSSIZE samples of its input
+  template<typename DataType>
+  void process(ATK::DynamicModellerFilter<DataType>& model, ATK::InPointerFilter<DataType>& generator)
+  {
+    model.set_input_sampling_rate(SAMPLING_RATE);
+    model.set_output_sampling_rate(SAMPLING_RATE);
+    model.set_input_port(0, &generator, 0);
+    model.setup();
+
+    model.process(PROCESSSIZE);
+  }
+
+  /**
+   * Processes the same signal with two modellers and checks that all their outputs are close
+   * The input ports of the modellers are left on temporary generators, they have to be set again before processing more samples
+   * @param model is the reference modeller
+   * @param other_model is the modeller compared to the reference, possibly in another precision
+   * @param data is the input signal
+   * @param tolerance is the biggest absolute difference allowed between two outputs
+   */
+  template<typename DataType, typename OtherDataType>
+  void compare_models(ATK::DynamicModellerFilter<DataType>& model, ATK::DynamicModellerFilter<OtherDataType>& other_model, const std::array<double, PROCESSSIZE>& data, double tolerance)
+  {
+    std::array<DataType, PROCESSSIZE> input;
+    std::copy(data.begin(), data.end(), input.begin());
+    ATK::InPointerFilter<DataType> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+    process(model, generator);
+
+    std::array<OtherDataType, PROCESSSIZE> other_input;
+    std::copy(data.begin(), data.end(), other_input.begin());
+    ATK::InPointerFilter<OtherDataType> other_generator(other_input.data(), 1, PROCESSSIZE, false);
+    other_generator.set_output_sampling_rate(SAMPLING_RATE);
+    process(other_model, other_generator);
+
+    BOOST_REQUIRE_EQUAL(model.get_nb_output_ports(), other_model.get_nb_output_ports());
+    for(gsl::index j = 0; j < model.get_nb_output_ports(); ++j)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        BOOST_CHECK_SMALL(model.get_output_array(j)[i] - other_model.get_output_array(j)[i], tolerance);
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * \ file Potentiometer.cpp
+ */
+
+#include <algorithm>
+#include <array>
+
+#include <ATK/config.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/Potentiometer.h>
+#include <ATK/Modelling/Resistor.h>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+static constexpr gsl::index PROCESSSIZE = 1000;
+
+namespace
+{
+  /// Ratio of the wiper voltage when one end is at the input and the other one at the ground
+  double divider(double position)
+  {
+    double R0 = std::max(position, 1e-4);
+    double R1 = std::max(1 - position, 1e-4);
+    return R1 / (R0 + R1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_divider )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::cos(i);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Potentiometer<double>>(10000, 0.25), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+
+  BOOST_CHECK(model.is_linear());
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - data[i] * divider(0.25), 1e-8);
+  }
+
+  BOOST_CHECK_EQUAL(model.get_parameter_name(1), "position");
+  model.set_parameter(1, 0.75);
+  BOOST_CHECK_EQUAL(model.get_parameter(1), 0.75);
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - data[i + PROCESSSIZE / 2] * divider(0.75), 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_position_ramp )
+{
+  std::array<double, PROCESSSIZE> data;
+  data.fill(1);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  // The wiper is loaded, so that the whole jacobian changes with the position
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Potentiometer<double>>(10000, 0), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(10000), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+  model.process(1);
+
+  BOOST_CHECK(model.push_parameter(model.get_parameter_handle("position"), 1, ATK::ParameterSmoothing::Linear, 100));
+  model.process(PROCESSSIZE - 1);
+  for(gsl::index i = 0; i < PROCESSSIZE - 1; ++i)
+  {
+    double position = std::min(1., (i + 1) / 100.);
+    double R0 = 10000 * std::max(position, 1e-4);
+    double R1 = 1 / (1 / (10000 * std::max(1 - position, 1e-4)) + 1 / 10000.);
+    BOOST_REQUIRE_CLOSE(model.get_output_array(0)[i], R1 / (R0 + R1), 0.0001);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_control_pin )
+{
+  std::array<double, PROCESSSIZE> data;
+  std::array<double, PROCESSSIZE> control;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::cos(i);
+    control[i] = (i % 200) / 150.;
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::InPointerFilter<double> control_generator(control.data(), 1, PROCESSSIZE, false);
+  control_generator.set_output_sampling_rate(48000);
+
+  ATK::DynamicModellerFilter<double> model(1, 1, 2);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Potentiometer<double>>(10000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Input, 1)}});
+  model.set_input_port(0, &generator, 0);
+  model.set_input_port(1, &control_generator, 0);
+
+  BOOST_CHECK(!model.is_linear());
+  model.process(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - data[i] * divider(std::min(control[i], 1.)), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_track_resistance )
+{
+  // The minimum resistance is only used near the ends of the track
+  ATK::Potentiometer<double> potentiometer(10000, 0.25);
+  for(auto position: {0., 0.25, 0.5, 1.})
+  {
+    potentiometer.set_parameter(1, position);
+    BOOST_CHECK_CLOSE(1 / potentiometer.get_gradient(0, 1, false) + 1 / potentiometer.get_gradient(2, 1, false), 10000 * (position == 0 || position == 1 ? 1 + 1e-4 : 1), 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_dynamic_control_pin )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i % 100) / 100.;
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  // The wiper controls its own position, so that the conductances depend on the solved voltage: V = Vin (1 - V)
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  // A small track resistance, so that the convergence on the currents is tight on the voltage
+  model.add_component(std::make_unique<ATK::Potentiometer<double>>(100), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.set_input_port(0, &generator, 0);
+  model.enable_statistics(true);
+
+  BOOST_CHECK(!model.is_linear());
+  model.process(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - data[i] / (1 + data[i]), 1e-6);
+  }
+  // The gradient of the conductances with the control voltage gives the Newton iterations their quadratic convergence
+  BOOST_CHECK_EQUAL(model.get_statistics().nb_not_converged, 0);
+  BOOST_CHECK_LT(model.get_statistics().nb_iterations, 3 * PROCESSSIZE);
+}
+
+BOOST_AUTO_TEST_CASE( Potentiometer_bad_parameter )
+{
+  ATK::Potentiometer<double> potentiometer(10000);
+  BOOST_CHECK_EQUAL(potentiometer.get_number_parameters(), 2);
+  BOOST_CHECK_THROW(potentiometer.get_parameter(2), ATK::RuntimeError);
+  potentiometer.set_parameter(1, 2);
+  BOOST_CHECK_EQUAL(potentiometer.get_position(), 1);
+}
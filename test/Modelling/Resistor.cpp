@@ -3,11 +3,13 @@
  */
 
 #include <array>
+#include <functional>
 
 #include <ATK/config.h>
 
 #include <ATK/Core/InPointerFilter.h>
 #include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
 
 #include <ATK/Modelling/DynamicModellerFilter.h>
 #include <ATK/Modelling/Resistor.h>
@@ -137,3 +139,105 @@ BOOST_AUTO_TEST_CASE( Resistor_Import_Bridge)
     BOOST_CHECK_CLOSE((1 + data[i]) / 3, model.get_output_array(0)[i], 0.0001);
   }
 }
+
+BOOST_AUTO_TEST_CASE( Resistor_parameters )
+{
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(200), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+
+  BOOST_CHECK_EQUAL(model.get_number_parameters(), 2);
+  BOOST_CHECK_EQUAL(model.get_parameter_name(1), "R");
+  BOOST_CHECK_EQUAL(model.get_parameter(0), 100);
+  BOOST_CHECK_EQUAL(model.get_parameter(1), 200);
+  BOOST_CHECK_THROW(model.get_parameter(2), ATK::RuntimeError);
+
+  model.set_parameter(1, 300);
+  BOOST_CHECK_EQUAL(model.get_parameter(1), 300);
+  auto handle = model.get_parameter_handle(1);
+  model.set_parameter(handle, 400);
+  BOOST_CHECK_EQUAL(model.get_parameter(1), 400);
+  BOOST_CHECK(model.get_parameter_handle("R") == model.get_parameter_handle(0));
+  BOOST_CHECK_THROW(model.get_parameter_handle("C"), ATK::RuntimeError);
+}
+
+namespace
+{
+  /// Divider with a constant input of 1V, the output is 100 / (100 + R)
+  void check_smoothed_divider(ATK::ParameterSmoothing smoothing, gsl::index samples, std::function<double(gsl::index)> resistance)
+  {
+    std::array<double, PROCESSSIZE> data;
+    data.fill(1);
+
+    ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000);
+
+    ATK::DynamicModellerFilter<double> model(1, 1, 1);
+    model.set_input_sampling_rate(48000);
+    model.set_output_sampling_rate(48000);
+    model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model.add_component(std::make_unique<ATK::Resistor<double>>(200), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+    model.set_input_port(0, &generator, 0);
+
+    model.process(1);
+    BOOST_CHECK_CLOSE(model.get_output_array(0)[0], 1. / 3, 0.0001);
+
+    BOOST_CHECK(model.push_parameter(model.get_parameter_handle(1), 100, smoothing, samples));
+    model.process(PROCESSSIZE - 1);
+    for(gsl::index i = 0; i < PROCESSSIZE - 1; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(model.get_output_array(0)[i], 100 / (100 + resistance(i)), 0.0001);
+    }
+    BOOST_CHECK_EQUAL(model.get_parameter(1), 100);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Resistor_parameter_queue )
+{
+  check_smoothed_divider(ATK::ParameterSmoothing::None, 10, [](gsl::index i){return 100.;});
+}
+
+BOOST_AUTO_TEST_CASE( Resistor_parameter_linear_smoothing )
+{
+  check_smoothed_divider(ATK::ParameterSmoothing::Linear, 10, [](gsl::index i){return std::max(100., 200. - 10 * (i + 1));});
+}
+
+BOOST_AUTO_TEST_CASE( Resistor_parameter_exponential_smoothing )
+{
+  check_smoothed_divider(ATK::ParameterSmoothing::Exponential, 10, [](gsl::index i){return i + 1 < 100 ? 100 + 100 * std::exp(-(i + 1) / 10.) : 100;});
+}
+
+BOOST_AUTO_TEST_CASE( Resistor_parameter_low_rank_updates )
+{
+  std::array<double, PROCESSSIZE> data;
+  data.fill(1);
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  // Input - R1 - pin 0 - R2 - pin 1 - R3 - ground
+  ATK::DynamicModellerFilter<double> model(2, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Dynamic, 1)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(100), {{std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+  model.process(1);
+
+  // Both resistors change at each sample, the factorization is updated instead of computed again
+  BOOST_CHECK(model.push_parameter(model.get_parameter_handle(0), 200, ATK::ParameterSmoothing::Linear, 100));
+  BOOST_CHECK(model.push_parameter(model.get_parameter_handle(1), 50, ATK::ParameterSmoothing::Exponential, 20));
+  model.process(PROCESSSIZE - 2);
+  for(gsl::index i = 0; i < PROCESSSIZE - 2; ++i)
+  {
+    double R1 = std::min(200., 100. + (i + 1));
+    double R2 = i + 1 < 200 ? 50 + 50 * std::exp(-(i + 1) / 20.) : 50;
+    BOOST_REQUIRE_CLOSE(model.get_output_array(0)[i], (R2 + 100) / (R1 + R2 + 100), 0.0001);
+    BOOST_REQUIRE_CLOSE(model.get_output_array(1)[i], 100 / (R1 + R2 + 100), 0.0001);
+  }
+
+  model.set_parameter(2, 300);
+  model.process(1);
+  BOOST_CHECK_CLOSE(model.get_output_array(1)[0], 300. / 550, 0.0001);
+}
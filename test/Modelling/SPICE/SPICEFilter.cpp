@@ -2,9 +2,11 @@
  * \ file SPICEFilter.cpp
  */
 
+#include <ATK/Modelling/DynamicModellerFilter.h>
 #include <ATK/Modelling/ModellerFilter.h>
 #include <ATK/Modelling/SPICE/SPICEFilter.h>
 
+#include <ATK/Core/InPointerFilter.h>
 #include <ATK/Core/Utilities.h>
 
 #define BOOST_TEST_DYN_LINK
@@ -12,6 +14,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include "../ModellerTestCircuits.h"
+
 BOOST_AUTO_TEST_CASE( SPICE_Filter_check_non_existing )
 {
   BOOST_CHECK_THROW(ATK::parse<double>("foo"), std::runtime_error);
@@ -33,3 +37,74 @@ BOOST_AUTO_TEST_CASE( SPICE_Filter_check_existing )
   BOOST_CHECK_EQUAL(filter->get_dynamic_pin_name(0), "in");
   BOOST_CHECK_EQUAL(filter->get_dynamic_pin_name(4), "out");
 }
+
+BOOST_AUTO_TEST_CASE( SPICE_Filter_junction_limiting_steady_state )
+{
+  // The branch of the ladder that is cut off has high impedance nodes, the limitation must not change their steady state
+  auto filter = ATK::parse<double>("SPICE/moog.cir");
+  filter->set_input_sampling_rate(48000);
+  filter->set_output_sampling_rate(48000);
+  auto filter_limited = ATK::parse<double>("SPICE/moog.cir");
+  auto dynamic_limited = dynamic_cast<ATK::DynamicModellerFilter<double>*>(filter_limited.get());
+  BOOST_REQUIRE(dynamic_limited);
+  dynamic_limited->set_junction_limiting(true);
+  filter_limited->set_input_sampling_rate(48000);
+  filter_limited->set_output_sampling_rate(48000);
+
+  const auto& state = dynamic_cast<ATK::DynamicModellerFilter<double>&>(*filter).get_dynamic_state();
+  for(gsl::index i = 0; i < state.size(); ++i)
+  {
+    BOOST_CHECK_SMALL(state(i) - dynamic_limited->get_dynamic_state()(i), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_Filter_sparse_solver )
+{
+  // The ladder has enough nodes for the sparse factorization to have fill-in, the pattern analyzed in setup() is kept after a parameter change
+  auto data = create_sine(1);
+  std::array<std::unique_ptr<ATK::ModellerFilter<double>>, 2> filters{{ATK::parse<double>("SPICE/moog.cir"), ATK::parse<double>("SPICE/moog.cir")}};
+  std::array<std::unique_ptr<ATK::InPointerFilter<double>>, 2> generators;
+  for(gsl::index i = 0; i < 2; ++i)
+  {
+    auto dynamic = dynamic_cast<ATK::DynamicModellerFilter<double>*>(filters[i].get());
+    BOOST_REQUIRE(dynamic);
+    dynamic->set_solver_type(i == 0 ? ATK::SolverType::Dense : ATK::SolverType::Sparse);
+    dynamic->enable_statistics(true);
+    BOOST_REQUIRE_EQUAL(filters[i]->get_nb_input_pins(), 1);
+    generators[i] = std::make_unique<ATK::InPointerFilter<double>>(data.data(), 1, PROCESSSIZE, false);
+    generators[i]->set_output_sampling_rate(SAMPLING_RATE);
+    filters[i]->set_input_sampling_rate(SAMPLING_RATE);
+    filters[i]->set_output_sampling_rate(SAMPLING_RATE);
+    filters[i]->set_input_port(0, generators[i].get(), 0);
+  }
+  BOOST_REQUIRE_GT(filters[0]->get_nb_dynamic_pins(), 8);
+
+  gsl::index resistor = 0;
+  while(filters[0]->get_parameter_name(resistor) != "R")
+  {
+    ++resistor;
+  }
+
+  for(gsl::index half = 0; half < 2; ++half)
+  {
+    if(half == 1)
+    {
+      filters[0]->set_parameter(resistor, 10000);
+      filters[1]->set_parameter(resistor, 10000);
+    }
+    filters[0]->process(PROCESSSIZE / 2);
+    filters[1]->process(PROCESSSIZE / 2);
+    for(gsl::index j = 0; j < filters[0]->get_nb_output_ports(); ++j)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+      {
+        BOOST_CHECK_SMALL(filters[0]->get_output_array(j)[i] - filters[1]->get_output_array(j)[i], 1e-6);
+      }
+    }
+  }
+
+  // The sparse solver factorized the jacobian with the cached pattern at each iteration of the second half
+  auto statistics_sparse = dynamic_cast<ATK::DynamicModellerFilter<double>&>(*filters[1]).get_statistics();
+  BOOST_CHECK_GT(statistics_sparse.nb_iterations, 0);
+  BOOST_CHECK_EQUAL(statistics_sparse.nb_factorizations, statistics_sparse.nb_iterations);
+}
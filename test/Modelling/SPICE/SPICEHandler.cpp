@@ -2,6 +2,8 @@
  * \ file SPICEHandler.cpp
  */
 
+#include <algorithm>
+
 #include <ATK/Core/InPointerFilter.h>
 
 #include <ATK/Modelling/SPICE/SPICEHandler.h>
@@ -388,3 +390,109 @@ BOOST_AUTO_TEST_CASE( SPICE_Handler_current )
   auto output0 = filter->get_output_array(0);
   BOOST_CHECK_CLOSE(output0[0], .2, 0.01);
 }
+
+BOOST_AUTO_TEST_CASE( SPICE_Handler_potentiometer )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vcc ref 0 5V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "P1 ref 1 0 10k 0.25"));
+  auto filter = ATK::SPICEHandler<double>::convert(ast);
+  filter->set_input_sampling_rate(sampling_reate);
+  filter->set_output_sampling_rate(sampling_reate);
+  filter->process(1);
+  BOOST_CHECK_CLOSE(filter->get_output_array(0)[0], 5 * 0.75, 0.001);
+  BOOST_CHECK_EQUAL(filter->get_parameter(1), 0.25);
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_Handler_potentiometer_control )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vcc ref 0 5V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vctrl ctrl 0 AC 1V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "P1 ref 1 0 10k ctrl"));
+  auto filter = ATK::SPICEHandler<double>::convert(ast);
+  filter->set_input_sampling_rate(sampling_reate);
+  filter->set_output_sampling_rate(sampling_reate);
+
+  std::vector<double> data(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i % 101) / 100.;
+  }
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(sampling_reate);
+  filter->set_input_port(0, generator, 0);
+
+  filter->process(PROCESSSIZE);
+  auto output = filter->get_output_array(0);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    // The track keeps a minimum resistance near its ends
+    double R0 = std::max(data[i], 1e-4);
+    double R1 = std::max(1 - data[i], 1e-4);
+    BOOST_REQUIRE_SMALL(output[i] - 5 * R1 / (R0 + R1), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_Handler_voltage_controlled_current )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vctrl ctrl 0 AC 1V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "G1 0 1 ctrl 0 1m"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "R1 1 0 1k"));
+  auto filter = ATK::SPICEHandler<double>::convert(ast);
+  filter->set_input_sampling_rate(sampling_reate);
+  filter->set_output_sampling_rate(sampling_reate);
+
+  std::vector<double> data(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i % 101) / 100.;
+  }
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(sampling_reate);
+  filter->set_input_port(0, generator, 0);
+
+  filter->process(PROCESSSIZE);
+  auto output = filter->get_output_array(0);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_SMALL(output[i] - data[i], 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_Handler_exponential_controlled_current )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vctrl ctrl 0 AC 1V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "G1 0 1 ctrl 0 exp 1m 0.1"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "R1 1 0 1k"));
+  auto filter = ATK::SPICEHandler<double>::convert(ast);
+  filter->set_input_sampling_rate(sampling_reate);
+  filter->set_output_sampling_rate(sampling_reate);
+
+  std::vector<double> data(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = (i % 101) / 1000.;
+  }
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(sampling_reate);
+  filter->set_input_port(0, generator, 0);
+
+  filter->process(PROCESSSIZE);
+  auto output = filter->get_output_array(0);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(output[i], std::exp(data[i] / 0.1), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_Handler_voltage_controlled_current_bad_law )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "Vctrl ctrl 0 AC 1V"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "G1 0 1 ctrl 0 log 1m"));
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "R1 1 0 1k"));
+  BOOST_CHECK_THROW(ATK::SPICEHandler<double>::convert(ast), ATK::RuntimeError);
+}
@@ -152,6 +152,32 @@ BOOST_AUTO_TEST_CASE( SPICE_parse_resistor_fail )
   BOOST_CHECK_EQUAL(ast.components.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE( SPICE_parse_potentiometer )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "P1 in wiper 0 10k ctrl"));
+  BOOST_REQUIRE_EQUAL(ast.components.size(), 1);
+  const auto& it = *ast.components.begin();
+  BOOST_CHECK_EQUAL(it.first, "p1");
+  BOOST_REQUIRE_EQUAL(it.second.size(), 5);
+  BOOST_CHECK_EQUAL(boost::get<std::string>(it.second[1]), "wiper");
+  BOOST_CHECK_EQUAL(ATK::convert_component_value(boost::get<ATK::ast::SPICENumber>(it.second[3])), 10000.);
+  BOOST_CHECK_EQUAL(boost::get<std::string>(it.second[4]), "ctrl");
+}
+
+BOOST_AUTO_TEST_CASE( SPICE_parse_voltage_controlled_current )
+{
+  ATK::ast::SPICEAST ast;
+  BOOST_CHECK_NO_THROW(ATK::parse_string(ast, "G1 lt 0 cv 0 exp 10u"));
+  BOOST_REQUIRE_EQUAL(ast.components.size(), 1);
+  const auto& it = *ast.components.begin();
+  BOOST_CHECK_EQUAL(it.first, "g1");
+  BOOST_REQUIRE_EQUAL(it.second.size(), 6);
+  BOOST_CHECK_EQUAL(boost::get<std::string>(it.second[2]), "cv");
+  BOOST_CHECK_EQUAL(boost::get<std::string>(it.second[4]), "exp");
+  BOOST_CHECK_CLOSE(ATK::convert_component_value(boost::get<ATK::ast::SPICENumber>(it.second[5])), 10e-6, 1e-8);
+}
+
 BOOST_AUTO_TEST_CASE( SPICE_parse_voltage )
 {
   ATK::ast::SPICEAST ast;
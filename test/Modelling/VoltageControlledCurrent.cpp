@@ -0,0 +1,155 @@
+/**
+ * \ file VoltageControlledCurrent.cpp
+ */
+
+#include <array>
+
+#include <ATK/config.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Modelling/DynamicModellerFilter.h>
+#include <ATK/Modelling/ExponentialControlledCurrent.h>
+#include <ATK/Modelling/Resistor.h>
+#include <ATK/Modelling/VoltageControlledCurrent.h>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+static constexpr gsl::index PROCESSSIZE = 1000;
+
+BOOST_AUTO_TEST_CASE( VoltageControlledCurrent_input_control )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::cos(i);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::VoltageControlledCurrent<double>>(2e-3), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+
+  BOOST_CHECK(model.is_linear());
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - 2 * data[i], 1e-8);
+  }
+
+  BOOST_CHECK_EQUAL(model.get_parameter_name(0), "G");
+  model.set_parameter(0, 5e-3);
+  BOOST_CHECK_EQUAL(model.get_parameter(0), 5e-3);
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - 5 * data[i + PROCESSSIZE / 2], 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( VoltageControlledCurrent_dynamic_control )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::cos(i);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  // The control voltage is the middle of a divider, the output is loaded by a resistor
+  ATK::DynamicModellerFilter<double> model(2, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::VoltageControlledCurrent<double>>(1e-3), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(2000), {{std::make_tuple(ATK::PinType::Dynamic, 1), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+
+  BOOST_CHECK(model.is_linear());
+  model.process(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    BOOST_REQUIRE_SMALL(model.get_output_array(0)[i] - data[i] / 2, 1e-8);
+    BOOST_REQUIRE_SMALL(model.get_output_array(1)[i] + data[i], 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ExponentialControlledCurrent_input_control )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = 0.05 * std::cos(i);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::ExponentialControlledCurrent<double>>(1e-3), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+
+  BOOST_CHECK(!model.is_linear());
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(model.get_output_array(0)[i], std::exp(data[i] / 26e-3), 1e-6);
+  }
+
+  BOOST_CHECK_EQUAL(model.get_parameter_name(0), "Is");
+  model.set_parameter(0, 2e-3);
+  model.process(PROCESSSIZE / 2);
+  for(gsl::index i = 0; i < PROCESSSIZE / 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(model.get_output_array(0)[i], 2 * std::exp(data[i + PROCESSSIZE / 2] / 26e-3), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ExponentialControlledCurrent_dynamic_control )
+{
+  std::array<double, PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::cos(i);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  // Controlled by its own voltage, the generator behaves like a diode to the ground
+  ATK::DynamicModellerFilter<double> model(1, 1, 1);
+  model.set_input_sampling_rate(48000);
+  model.set_output_sampling_rate(48000);
+  model.add_component(std::make_unique<ATK::Resistor<double>>(1000), {{std::make_tuple(ATK::PinType::Input, 0), std::make_tuple(ATK::PinType::Dynamic, 0)}});
+  model.add_component(std::make_unique<ATK::ExponentialControlledCurrent<double>>(1e-12), {{std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0), std::make_tuple(ATK::PinType::Dynamic, 0), std::make_tuple(ATK::PinType::Static, 0)}});
+  model.set_input_port(0, &generator, 0);
+
+  model.process(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    auto voltage = model.get_output_array(0)[i];
+    BOOST_REQUIRE_SMALL((data[i] - voltage) / 1000 - 1e-12 * std::exp(voltage / 26e-3), 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( VoltageControlledCurrent_bad_parameter )
+{
+  ATK::VoltageControlledCurrent<double> linear(1e-3);
+  BOOST_CHECK_THROW(linear.get_parameter(1), ATK::RuntimeError);
+  ATK::ExponentialControlledCurrent<double> exponential(1e-3);
+  BOOST_CHECK_THROW(exponential.set_parameter(1, 0), ATK::RuntimeError);
+}
@@ -13,3 +13,11 @@ def parseSimpleAST_test():
 def createDynamic_test():
     ast = AST()
     filter = DoubleModellerFilter.create_dynamic_filter(ast)
+
+def snapshot_test():
+    ast = AST()
+    filter = DoubleModellerFilter.create_dynamic_filter(ast)
+    filter.input_sampling_rate = 48000
+    filter.output_sampling_rate = 48000
+    snapshot = filter.save_snapshot()
+    filter.clone().restore_snapshot(snapshot)